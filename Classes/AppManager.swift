@@ -48,9 +48,7 @@ enum NetworkType: Int {
 		var filePath = "recording_"
 		filePath = filePath.appending(address.isEmpty ? address : "unknow")
 		let now = Date()
-		let dateFormat = DateFormatter()
-		dateFormat.dateFormat = "E-d-MMM-yyyy-HH-mm-ss"
-		let date = dateFormat.string(from: now)
+		let date = DateFormatterCache.sharedCache().string(from: now, format: "E-d-MMM-yyyy-HH-mm-ss")
 		
 		filePath = filePath.appending("_\(date).mkv")
 		
@@ -176,7 +176,17 @@
 	cell.displayNameLabel.text = [FastAddressBook displayNameForAddress:addr];
 	cell.addressLabel.text = linphoneContact ? [NSString stringWithUTF8String:linphone_address_as_string(addr)] : phoneOrAddr;
 	cell.selectedImage.hidden = ![_contactsGroup containsObject:cell.addressLabel.text];
-    [cell.avatarImage setImage:[FastAddressBook imageForAddress:addr] bordered:NO withRoundedRadius:YES];
+	NSString *cellAddress = cell.addressLabel.text;
+	__weak UIChatCreateCell *weakCell = cell;
+	UIImage *avatar = [FastAddressBook thumbnailForAddress:addr
+													  side:cell.avatarImage.bounds.size.width
+												completion:^(UIImage *thumbnail) {
+												  UIChatCreateCell *reusedCell = weakCell;
+												  // the cell may have been reused meanwhile
+												  if (reusedCell && [reusedCell.addressLabel.text isEqualToString:cellAddress])
+													  [reusedCell.avatarImage setImage:thumbnail bordered:NO withRoundedRadius:YES];
+												}];
+	[cell.avatarImage setImage:avatar bordered:NO withRoundedRadius:YES];
 	return cell;
 }
 
@@ -37,8 +37,13 @@
 
 @interface ChatConversationTableView : UICheckBoxTableView {
   @private
+	// window of the history currently loaded, sorted from the oldest to the most recent event
 	NSMutableArray *eventList;
-    NSMutableArray *totalEventList;
+	// number of more recent events of the history that are not in eventList
+	NSInteger eventListOffset;
+	// the oldest event of the history is in eventList
+	BOOL historyComplete;
+	BOOL loadingNewerEvents;
 }
 
 @property(nonatomic) LinphoneChatRoom *chatRoom;
@@ -25,6 +25,10 @@
 #import "UIChatNotifiedEventCell.h"
 #import "PhoneMainView.h"
 
+static const int BASIC_EVENT_LIST=15;
+// number of history events kept in memory, the farthest ones from the displayed page are released beyond it
+static const int MAX_EVENT_WINDOW=150;
+
 @implementation ChatConversationTableView
 
 #pragma mark - Lifecycle Functions
@@ -45,38 +49,45 @@
 
 #pragma mark -
 
+- (void)releaseEventsInRange:(NSRange)range {
+	for (NSValue *value in [eventList subarrayWithRange:range]) {
+		linphone_event_log_unref(value.pointerValue);
+	}
+	[eventList removeObjectsInRange:range];
+}
+
 - (void)clearEventList {
-    for (NSValue *value in totalEventList) {
-        LinphoneEventLog *event = value.pointerValue;
-        linphone_event_log_unref(event);
-    }
-    [eventList removeAllObjects];
-    [totalEventList removeAllObjects];
+	[self releaseEventsInRange:NSMakeRange(0, eventList.count)];
+	eventListOffset = 0;
+	historyComplete = FALSE;
 }
 
-- (void)updateData {
-    [self clearEventList];
-	if (!_chatRoom)
-		return;
-    
+// Loads count events of the history starting at begin, counted from the most recent event. The events are returned
+// sorted from the oldest to the most recent, with a reference taken on each of them.
+- (NSArray<NSValue *> *)loadHistoryFrom:(NSInteger)begin count:(NSInteger)count {
+	CFTimeInterval start = CACurrentMediaTime();
 	LinphoneChatRoomCapabilitiesMask capabilities = linphone_chat_room_get_capabilities(_chatRoom);
 	bctbx_list_t *chatRoomEvents = (capabilities & LinphoneChatRoomCapabilitiesOneToOne)
-		? linphone_chat_room_get_history_message_events(_chatRoom, 0)
-		: linphone_chat_room_get_history_events(_chatRoom, 0);
-    bctbx_list_t *head = chatRoomEvents;
-    size_t listSize = bctbx_list_size(chatRoomEvents);
-	totalEventList = [[NSMutableArray alloc] initWithCapacity:listSize];
-    eventList = [[NSMutableArray alloc] initWithCapacity:MIN(listSize, BASIC_EVENT_LIST)];
-	while (chatRoomEvents) {
-        LinphoneEventLog *event = (LinphoneEventLog *)chatRoomEvents->data;
-        [totalEventList addObject:[NSValue valueWithPointer:linphone_event_log_ref(event)]];
-        if (listSize <= BASIC_EVENT_LIST) {            
-            [eventList addObject:[NSValue valueWithPointer:linphone_event_log_ref(event)]];
-        }
-		chatRoomEvents = chatRoomEvents->next;
-        listSize -= 1;
+		? linphone_chat_room_get_history_range_message_events(_chatRoom, (int)begin, (int)(begin + count))
+		: linphone_chat_room_get_history_range_events(_chatRoom, (int)begin, (int)(begin + count));
+	NSMutableArray<NSValue *> *events = [NSMutableArray arrayWithCapacity:count];
+	for (bctbx_list_t *it = chatRoomEvents; it; it = it->next) {
+		[events addObject:[NSValue valueWithPointer:linphone_event_log_ref((LinphoneEventLog *)it->data)]];
 	}
-    bctbx_list_free_with_data(head, (bctbx_list_free_func)linphone_event_log_unref);
+	bctbx_list_free_with_data(chatRoomEvents, (bctbx_list_free_func)linphone_event_log_unref);
+	LOGD(@"Loaded %lu events of chat room history from %ld in %.1f ms", (unsigned long)events.count, (long)begin,
+		 (CACurrentMediaTime() - start) * 1000.);
+	return events;
+}
+
+- (void)updateData {
+	[self clearEventList];
+	if (!_chatRoom)
+		return;
+
+	eventList = [[self loadHistoryFrom:0 count:BASIC_EVENT_LIST] mutableCopy];
+	historyComplete = (eventList.count < BASIC_EVENT_LIST);
+	[UIChatBubbleTextCell prefetchMediaSizesForEvents:eventList];
 
 	/*for (FileTransferDelegate *ftd in [LinphoneManager.instance fileTransferDelegates]) {
 		const LinphoneAddress *ftd_peer =
@@ -90,19 +101,64 @@
 }
 
 - (void)refreshData {
-    if (totalEventList.count <= eventList.count) {
-        _currentIndex = 0;
-        return;
-    }
-    
-    NSUInteger num = MIN(totalEventList.count-eventList.count, BASIC_EVENT_LIST);
-    _currentIndex = num - 1;
-    while (num) {
-        NSInteger index = totalEventList.count - eventList.count - 1;
-        [eventList insertObject:[totalEventList objectAtIndex:index] atIndex:0];
-        index -= 1;
-        num -= 1;
-    }
+	NSArray<NSValue *> *olderEvents =
+		historyComplete ? @[] : [self loadHistoryFrom:eventListOffset + eventList.count count:BASIC_EVENT_LIST];
+	if (olderEvents.count < BASIC_EVENT_LIST)
+		historyComplete = TRUE;
+	if (olderEvents.count == 0) {
+		_currentIndex = 0;
+		return;
+	}
+
+	[eventList insertObjects:olderEvents atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, olderEvents.count)]];
+	_currentIndex = olderEvents.count - 1;
+	if (eventList.count > MAX_EVENT_WINDOW) {
+		// the most recent events will be loaded again when scrolling down
+		NSUInteger excess = eventList.count - MAX_EVENT_WINDOW;
+		[self releaseEventsInRange:NSMakeRange(MAX_EVENT_WINDOW, excess)];
+		eventListOffset += excess;
+	}
+	[UIChatBubbleTextCell prefetchMediaSizesForEvents:olderEvents];
+}
+
+- (void)loadNewerEvents {
+	NSInteger count = MIN(eventListOffset, BASIC_EVENT_LIST);
+	NSArray<NSValue *> *newerEvents = [self loadHistoryFrom:eventListOffset - count count:count];
+	eventListOffset -= count;
+	[eventList addObjectsFromArray:newerEvents];
+
+	CGFloat removedHeight = [self releaseOldestEvents];
+	[self.tableView reloadData];
+	[self scrollUpBy:removedHeight];
+	[UIChatBubbleTextCell prefetchMediaSizesForEvents:newerEvents];
+}
+
+// Releases the oldest events beyond MAX_EVENT_WINDOW, they will be loaded again when scrolling up. Returns the height
+// of the rows that were displaying them, the table view must be reloaded.
+- (CGFloat)releaseOldestEvents {
+	if (eventList.count <= MAX_EVENT_WINDOW)
+		return 0;
+	NSUInteger excess = eventList.count - MAX_EVENT_WINDOW;
+	NSInteger rows = [self.tableView numberOfRowsInSection:0];
+	CGFloat removedHeight = 0;
+	if (rows > 0) {
+		NSIndexPath *first = [NSIndexPath indexPathForRow:0 inSection:0];
+		NSIndexPath *kept = [NSIndexPath indexPathForRow:MIN(excess, rows - 1) inSection:0];
+		removedHeight = CGRectGetMinY([self.tableView rectForRowAtIndexPath:kept]) -
+						CGRectGetMinY([self.tableView rectForRowAtIndexPath:first]);
+	}
+	[self releaseEventsInRange:NSMakeRange(0, excess)];
+	historyComplete = FALSE;
+	return removedHeight;
+}
+
+// keeps what is displayed at the same place once rows above it were removed
+- (void)scrollUpBy:(CGFloat)height {
+	if (height <= 0)
+		return;
+	CGPoint offset = self.tableView.contentOffset;
+	offset.y = MAX(offset.y - height, -self.tableView.contentInset.top);
+	self.tableView.contentOffset = offset;
 }
 
 - (void)reloadData {
@@ -112,8 +168,18 @@
 }
 
 - (void)addEventEntry:(LinphoneEventLog *)event {
+	if (eventListOffset > 0) {
+		// the most recent events are not loaded, this one will be with them
+		eventListOffset++;
+		return;
+	}
 	[eventList addObject:[NSValue valueWithPointer:linphone_event_log_ref(event)]];
-    [totalEventList addObject:[NSValue valueWithPointer:linphone_event_log_ref(event)]];
+	if (eventList.count > MAX_EVENT_WINDOW) {
+		CGFloat removedHeight = [self releaseOldestEvents];
+		[self.tableView reloadData];
+		[self scrollUpBy:removedHeight];
+		return;
+	}
 	int pos = (int)eventList.count - 1;
 	NSIndexPath *indexPath = [NSIndexPath indexPathForRow:pos inSection:0];
 	[self.tableView beginUpdates];
@@ -124,16 +190,23 @@
 
 - (void)updateEventEntry:(LinphoneEventLog *)event {
 	NSInteger index = [eventList indexOfObject:[NSValue valueWithPointer:event]];
-	if (index < 0) {
+	if (index == NSNotFound) {
 		LOGW(@"event entry doesn't exist");
 		return;
 	}
+	if (linphone_event_log_get_type(event) == LinphoneEventLogTypeConferenceChatMessage)
+		[MessageLayoutCache.sharedCache invalidateMessage:linphone_event_log_get_chat_message(event)];
 	[self.tableView reloadRowsAtIndexPaths:[NSArray arrayWithObject:[NSIndexPath indexPathForRow:index inSection:0]]
 						  withRowAnimation:FALSE]; // just reload
     return;
 }
 
 - (void)scrollToBottom:(BOOL)animated {
+	if (eventListOffset > 0) {
+		// we are browsing older events, go back to the most recent ones
+		[self updateData];
+		[self.tableView reloadData];
+	}
 	//[self.tableView reloadData];
 	size_t count = eventList.count;
 	if (!count)
@@ -192,7 +265,6 @@
 }
 
 static const int MAX_AGGLOMERATED_TIME=300;
-static const int BASIC_EVENT_LIST=15;
 
 - (BOOL)isFirstIndexInTableView:(NSIndexPath *)indexPath chat:(LinphoneChatMessage *)chat {
     LinphoneEventLog *previousEvent = nil;
@@ -295,6 +367,18 @@ static const int BASIC_EVENT_LIST=15;
 	[_chatRoomDelegate tableViewIsScrolling];
 }
 
+- (void)scrollViewDidScroll:(UIScrollView *)scrollView {
+	if (eventListOffset == 0 || loadingNewerEvents || self.tableView.isEditing)
+		return;
+	// load the next page of more recent events when getting close to the bottom
+	CGFloat distanceToBottom = scrollView.contentSize.height - scrollView.contentOffset.y - scrollView.bounds.size.height;
+	if (distanceToBottom < scrollView.bounds.size.height) {
+		loadingNewerEvents = TRUE;
+		[self loadNewerEvents];
+		loadingNewerEvents = FALSE;
+	}
+}
+
 static const CGFloat MESSAGE_SPACING_PERCENTAGE = 1.f;
 
 - (CGFloat)tableView:(UITableView *)tableView heightForRowAtIndexPath:(NSIndexPath *)indexPath {
@@ -318,10 +402,7 @@ static const CGFloat MESSAGE_SPACING_PERCENTAGE = 1.f;
 	[tableView beginUpdates];
 	LinphoneEventLog *event = [[eventList objectAtIndex:indexPath.row] pointerValue];
 	linphone_event_log_delete_from_database(event);
-	NSInteger index = indexPath.row + _currentIndex + (totalEventList.count - eventList.count);
-	if (index < totalEventList.count)
-		[totalEventList removeObjectAtIndex:index];
-	[eventList removeObjectAtIndex:indexPath.row];
+	[self releaseEventsInRange:NSMakeRange(indexPath.row, 1)];
 
 	[tableView deleteRowsAtIndexPaths:[NSArray arrayWithObject:indexPath]
 					 withRowAnimation:UITableViewRowAnimationBottom];
@@ -366,10 +447,7 @@ static const CGFloat MESSAGE_SPACING_PERCENTAGE = 1.f;
 	[super removeSelectionUsing:^(NSIndexPath *indexPath) {
 		LinphoneEventLog *event = [[eventList objectAtIndex:indexPath.row] pointerValue];
 		linphone_event_log_delete_from_database(event);
-        NSInteger index = indexPath.row + _currentIndex + (totalEventList.count - eventList.count);
-        if (index < totalEventList.count)
-            [totalEventList removeObjectAtIndex:index];
-		[eventList removeObjectAtIndex:indexPath.row];
+		[self releaseEventsInRange:NSMakeRange(indexPath.row, 1)];
 	}];
 }
 
@@ -89,7 +89,6 @@
 @property (weak, nonatomic) IBOutlet UIInterfaceStyleButton *toggleSelectionButton;
 
 + (void)markAsRead:(LinphoneChatRoom *)chatRoom;
-+ (void)autoDownload:(LinphoneChatMessage *)message;
 
 - (void)configureForRoom:(BOOL)editing;
 - (IBAction)onBackClick:(id)event;
@@ -110,5 +109,6 @@
 - (void)showFileDownloadError;
 - (NSURL *)getICloudFileUrl:(NSString *)name;
 - (BOOL)writeFileInICloud:(NSData *)data fileURL:(NSURL *)fileURL;
+- (BOOL)moveFileInICloud:(NSURL *)localURL fileURL:(NSURL *)fileURL;
 
 @end
@@ -210,6 +210,7 @@ static UICompositeViewDescription *compositeDescription = nil;
 
 	[NSNotificationCenter.defaultCenter removeObserver:self];
 	PhoneMainView.instance.currentRoom = NULL;
+	LinphoneManager.instance.fileTransferScheduler.visibleChatRoom = NULL;
 }
 
 - (void)didRotateFromInterfaceOrientation:(UIInterfaceOrientation)fromInterfaceOrientation {
@@ -260,6 +261,7 @@ static UICompositeViewDescription *compositeDescription = nil;
 
 	[self callUpdateEvent:nil];
 	PhoneMainView.instance.currentRoom = _chatRoom;
+	LinphoneManager.instance.fileTransferScheduler.visibleChatRoom = _chatRoom;
 	LinphoneChatRoomCapabilitiesMask capabilities = linphone_chat_room_get_capabilities(_chatRoom);
 	if (capabilities & LinphoneChatRoomCapabilitiesOneToOne) {
 		bctbx_list_t *participants = linphone_chat_room_get_participants(_chatRoom);
@@ -412,6 +414,7 @@ static UICompositeViewDescription *compositeDescription = nil;
 
 	// we must ref & unref message because in case of error, it will be destroy otherwise
 	linphone_chat_message_send(msg);
+	[LinphoneManager.instance.coreScheduler wakeUp];
 
 	return TRUE;
 }
@@ -811,7 +814,7 @@ static UICompositeViewDescription *compositeDescription = nil;
 	[exportSession exportAsynchronouslyWithCompletionHandler:^{
 		dispatch_async(dispatch_get_main_queue(), ^{
 			[SVProgressHUD dismiss];
-			[self startFileUpload:[NSData dataWithContentsOfURL:compressedVideoUrl] withName:localname];
+			[self startFileUpload:[NSData dataWithContentsOfURL:compressedVideoUrl options:NSDataReadingMappedIfSafe error:nil] withName:localname];
 		});
 	}];
 	
@@ -1079,7 +1082,7 @@ void on_chat_room_chat_message_received(LinphoneChatRoom *cr, const LinphoneEven
 
     BOOL hasFile = FALSE;
     // if auto_download is available and file is downloaded
-    if ((linphone_core_get_max_size_for_auto_download_incoming_files(LC) > -1) && linphone_chat_message_get_file_transfer_information(chat))
+    if ((LinphoneManager.instance.autoDownloadMaxSize > -1) && linphone_chat_message_get_file_transfer_information(chat))
         hasFile = TRUE;
 
 	if (!linphone_chat_message_is_file_transfer(chat) && !linphone_chat_message_is_text(chat) && !hasFile) /*probably an imdn*/
@@ -1187,18 +1190,24 @@ void on_chat_room_conference_alert(LinphoneChatRoom *cr, const LinphoneEventLog
     return nil;
 }
 
-- (BOOL)writeFileInICloud:(NSData *)data fileURL:(NSURL *)fileURL {
-    NSFileManager *fileManager = [NSFileManager defaultManager];
+- (BOOL)checkICloudAvailable {
     BOOL useMyDevice = FALSE;
     if (@available(iOS 11.0, *)) {
         useMyDevice = TRUE;
     }
     
-    if (!useMyDevice && ![[fileManager URLForUbiquityContainerIdentifier:nil]URLByAppendingPathComponent:@"Documents"]) {
+    if (!useMyDevice && ![[[NSFileManager defaultManager] URLForUbiquityContainerIdentifier:nil]URLByAppendingPathComponent:@"Documents"]) {
         //notify : set configuration to use icloud
         [[[UIAlertView alloc] initWithTitle:NSLocalizedString(@"Info", nil) message:NSLocalizedString(@"ICloud Drive is unavailable.", nil) delegate:nil cancelButtonTitle:NSLocalizedString(@"Cancel", nil) otherButtonTitles:nil, nil] show];
         return FALSE;
     }
+    return TRUE;
+}
+
+- (BOOL)writeFileInICloud:(NSData *)data fileURL:(NSURL *)fileURL {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (![self checkICloudAvailable])
+        return FALSE;
 
 	NSString *fileName = fileURL.lastPathComponent;
     if ([fileManager fileExistsAtPath:[fileURL path]] || [fileName hasPrefix:@"recording"]) {
@@ -1222,6 +1231,25 @@ void on_chat_room_conference_alert(LinphoneChatRoom *cr, const LinphoneEventLog
     }
 }
 
+// Same as writeFileInICloud, for a file already on disk: it is moved instead of being loaded in memory
+- (BOOL)moveFileInICloud:(NSURL *)localURL fileURL:(NSURL *)fileURL {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (![self checkICloudAvailable])
+        return FALSE;
+
+    NSError *error;
+    BOOL moved;
+    if ([fileManager fileExistsAtPath:[fileURL path]]) {
+        // if it exists, replace the file
+        moved = [fileManager replaceItemAtURL:fileURL withItemAtURL:localURL backupItemName:nil options:0 resultingItemURL:nil error:&error];
+    } else {
+        moved = [fileManager setUbiquitous:YES itemAtURL:localURL destinationURL:fileURL error:&error];
+    }
+    if (!moved)
+        LOGE(@"Cannot move file in Icloud file [%@]",[error localizedDescription]);
+    return moved;
+}
+
 - (void)deleteImageWithAssetId:(NSString *)assetId {
     NSUInteger key = [_assetIdsArray indexOfObject:assetId];
     [_imagesArray removeObjectAtIndex:key];
@@ -1316,125 +1344,6 @@ void on_chat_room_conference_alert(LinphoneChatRoom *cr, const LinphoneEventLog
 	[PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
 }
 
-+ (void)autoDownload:(LinphoneChatMessage *)message {
-	ChatConversationView *view = VIEW(ChatConversationView);
-    //TODO: migrate with  "linphone_iphone_file_transfer_recv"
-    LinphoneContent *content = linphone_chat_message_get_file_transfer_information(message);
-    NSString *name = [NSString stringWithUTF8String:linphone_content_get_name(content)];
-    // get download path
-    NSString *filePath = [[LinphoneManager cacheDirectory] stringByAppendingPathComponent:name];
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    if ([fileManager fileExistsAtPath:filePath]) {
-        NSData* data = [NSData dataWithContentsOfFile:filePath];
-        NSString *fileType = [NSString stringWithUTF8String:linphone_content_get_type(content)];
-
-		// define a block , not called immediately. To avoid crash when saving photo before PHAuthorizationStatusNotDetermined.
-		void (^block)(void)= ^ {
-			if ([fileType isEqualToString:@"image"]) {
-				// we're finished, save the image and update the message
-				UIImage *image = [UIImage imageWithData:data];
-				if (!image) {
-					[view showFileDownloadError];
-					return;
-				}
-				__block PHObjectPlaceholder *placeHolder;
-				[[PHPhotoLibrary sharedPhotoLibrary] performChanges:^{
-					PHAssetCreationRequest *request = [PHAssetCreationRequest creationRequestForAssetFromImage:image];
-					placeHolder = [request placeholderForCreatedAsset];
-				} completionHandler:^(BOOL success, NSError *error) {
-					dispatch_async(dispatch_get_main_queue(), ^{
-						if (error) {
-							LOGE(@"Cannot save image data downloaded [%@]", [error localizedDescription]);
-							[LinphoneManager setValueInMessageAppData:nil forKey:@"localimage" inMessage:message];
-							UIAlertController *errView = [UIAlertController alertControllerWithTitle:NSLocalizedString(@"Transfer error", nil)
-																						 message:NSLocalizedString(@"Cannot write image to photo library",
-																												   nil)
-																				  preferredStyle:UIAlertControllerStyleAlert];
-						
-							UIAlertAction* defaultAction = [UIAlertAction actionWithTitle:@"OK"
-																				style:UIAlertActionStyleDefault
-																			  handler:^(UIAlertAction * action) {}];
-						
-							[errView addAction:defaultAction];
-							[PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
-						} else {
-							LOGI(@"Image saved to [%@]", [placeHolder localIdentifier]);
-							[LinphoneManager setValueInMessageAppData:[placeHolder localIdentifier]
-														   forKey:@"localimage"
-														inMessage:message];
-						}
-						[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneMessageReceived object:view];
-						[view.tableController scrollToLastUnread:TRUE];
-					});
-				}];
-			} else if([fileType isEqualToString:@"video"]) {
-				// until image is properly saved, keep a reminder on it so that the
-				// chat bubble is aware of the fact that image is being saved to device
-			
-				__block PHObjectPlaceholder *placeHolder;
-				[[PHPhotoLibrary sharedPhotoLibrary] performChanges:^{
-					PHAssetCreationRequest *request = [PHAssetCreationRequest creationRequestForAssetFromVideoAtFileURL:[NSURL fileURLWithPath:filePath]];
-					placeHolder = [request placeholderForCreatedAsset];
-				} completionHandler:^(BOOL success, NSError * _Nullable error) {
-					dispatch_async(dispatch_get_main_queue(), ^{
-						if (error) {
-							LOGE(@"Cannot save video data downloaded [%@]", [error localizedDescription]);
-							[LinphoneManager setValueInMessageAppData:nil forKey:@"localvideo" inMessage:message];
-							UIAlertController *errView = [UIAlertController alertControllerWithTitle:NSLocalizedString(@"Transfer error", nil)
-																						 message:NSLocalizedString(@"Cannot write video to photo library",
-																												   nil)
-																				  preferredStyle:UIAlertControllerStyleAlert];
-						
-							UIAlertAction* defaultAction = [UIAlertAction actionWithTitle:@"OK"
-																				style:UIAlertActionStyleDefault
-																			  handler:^(UIAlertAction * action) {}];
-						
-							[errView addAction:defaultAction];
-							[PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
-						} else {
-							LOGI(@"video saved to [%@]", [placeHolder localIdentifier]);
-							[LinphoneManager setValueInMessageAppData:[placeHolder localIdentifier]
-														   forKey:@"localvideo"
-														inMessage:message];
-						}
-						[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneMessageReceived object:view];
-						[view.tableController scrollToLastUnread:TRUE];
-					});
-				}];
-			}
-		};
-		
-		// When you save an image or video to a photo library, make sure that it is allowed. Otherwise, there will be a backup error.
-		if ([fileType isEqualToString:@"image"] || [fileType isEqualToString:@"video"]) {
-			if ([PHPhotoLibrary authorizationStatus] == PHAuthorizationStatusAuthorized) {
-				block();
-			} else {
-				[PHPhotoLibrary requestAuthorization:^(PHAuthorizationStatus status) {
-					dispatch_async(dispatch_get_main_queue(), ^{
-						if ([PHPhotoLibrary authorizationStatus] == PHAuthorizationStatusAuthorized) {
-							block();
-						} else {
-							[[[UIAlertView alloc] initWithTitle:NSLocalizedString(@"Photo's permission", nil) message:NSLocalizedString(@"Photo not authorized", nil) delegate:nil cancelButtonTitle:nil otherButtonTitles:@"Continue", nil] show];
-						}
-					});
-				}];
-			}
-		} else {
-			NSString *key =  @"localfile";
-			//write file to path
-			if([view writeFileInICloud:data fileURL:[view getICloudFileUrl:name]]) {
-			dispatch_async(dispatch_get_main_queue(), ^{
-				[LinphoneManager setValueInMessageAppData:name forKey:key inMessage:message];
-				//[LinphoneManager setValueInMessageAppData:filePath forKey:@"cachedfile" inMessage:message];
-				[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneMessageReceived object:view];
-				[view.tableController scrollToLastUnread:TRUE];
-			});} else {
-				LOGE(@"[Auto download error] can not save the file %@", name);
-			}
-		}
-	}
-}
-
 -(void) documentMenu:(UIDocumentMenuViewController *)documentMenu didPickDocumentPicker:(UIDocumentPickerViewController *)documentPicker {
 	documentPicker.delegate = self;
 	[PhoneMainView.instance presentViewController:documentPicker animated:YES completion:nil];
@@ -1445,7 +1354,7 @@ void on_chat_room_conference_alert(LinphoneChatRoom *cr, const LinphoneEventLog
 	NSFileCoordinator *co =[[NSFileCoordinator alloc] init];
 	NSError *error = nil;
 	[co coordinateReadingItemAtURL:url options:0 error:&error byAccessor:^(NSURL * _Nonnull newURL) {
-		[self startFileUpload:[NSData dataWithContentsOfURL:newURL] withName:[newURL lastPathComponent]];
+		[self startFileUpload:[NSData dataWithContentsOfURL:newURL options:NSDataReadingMappedIfSafe error:nil] withName:[newURL lastPathComponent]];
 	}];
 	[url stopAccessingSecurityScopedResource];
 }
@@ -26,9 +26,11 @@
 @property (nonatomic) NSInteger nbOfChatRoomToDelete;
 @property (nonatomic) bctbx_list_t *chatRooms;
 @property (weak, nonatomic) IBOutlet UIView *waitView;
-@property bctbx_list_t *data;
 
 - (void)loadData;
+/* a message was sent or received in this chat room, only its row is moved and updated */
+- (void)chatRoomUpdated:(LinphoneChatRoom *)chatRoom;
+- (LinphoneChatRoom *)chatRoomAtIndex:(NSInteger)index;
 - (void)markCellAsRead:(LinphoneChatRoom *)chatRoom;
 + (void)saveDataToUserDefaults;
 @end
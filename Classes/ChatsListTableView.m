@@ -26,14 +26,29 @@
 #import "PhoneMainView.h"
 #import "Utils.h"
 
-@implementation ChatsListTableView
+// a listed chat room, the time it was sorted by and what its row shows
+@interface ChatRoomListEntry : NSObject
+@property LinphoneChatRoom *chatRoom;
+@property time_t lastUpdateTime;
+@property(strong) UIChatCellModel *model;
+@end
+
+@implementation ChatRoomListEntry
+@end
+
+@implementation ChatsListTableView {
+	// most recent first
+	NSMutableArray<ChatRoomListEntry *> *entries;
+	// chat room -> its entry, rebuilt with entries
+	NSMapTable *entriesByChatRoom;
+}
 
 #pragma mark - Lifecycle Functions
 
 - (instancetype)init {
 	self = super.init;
 	if (self) {
-		_data = nil;
+		entries = [NSMutableArray array];
 		_nbOfChatRoomToDelete = 0;
 		_waitView.hidden = TRUE;
 	}
@@ -45,6 +60,18 @@
 - (void)viewWillAppear:(BOOL)animated {
 	[super viewWillAppear:animated];
 	self.tableView.accessibilityIdentifier = @"Chat list";
+	[NSNotificationCenter.defaultCenter addObserver:self
+										   selector:@selector(resetModels)
+											   name:kLinphoneAddressBookUpdate
+											 object:nil];
+	// the time of the rows is shown differently once the day changed
+	[NSNotificationCenter.defaultCenter addObserver:self
+										   selector:@selector(resetModels)
+											   name:UIApplicationSignificantTimeChangeNotification
+											 object:nil];
+	// subjects and security levels may have changed while the list was not on screen
+	for (ChatRoomListEntry *entry in entries)
+		entry.model = nil;
 	[self loadData];
 	_chatRooms = NULL;
 }
@@ -59,6 +86,10 @@
 }
 
 - (void)viewWillDisappear:(BOOL)animated {
+	[NSNotificationCenter.defaultCenter removeObserver:self name:kLinphoneAddressBookUpdate object:nil];
+	[NSNotificationCenter.defaultCenter removeObserver:self
+												 name:UIApplicationSignificantTimeChangeNotification
+											   object:nil];
 	while (_chatRooms) {
 		LinphoneChatRoom *chatRoom = (LinphoneChatRoom *)_chatRooms->data;
 		if (!chatRoom)
@@ -79,45 +110,102 @@
 
 #pragma mark -
 
-static int sorted_history_comparison(LinphoneChatRoom *to_insert, LinphoneChatRoom *elem) {
-	time_t new = linphone_chat_room_get_last_update_time(to_insert);
-	time_t old = linphone_chat_room_get_last_update_time(elem);
-	if (new < old)
-		return 1;
-	else if (new > old)
-		return -1;
-
-	return 0;
+static NSComparisonResult compareEntries(ChatRoomListEntry *a, ChatRoomListEntry *b) {
+	if (a.lastUpdateTime > b.lastUpdateTime)
+		return NSOrderedAscending;
+	if (a.lastUpdateTime < b.lastUpdateTime)
+		return NSOrderedDescending;
+	return NSOrderedSame;
 }
 
-- (MSList *)sortChatRooms {
-	MSList *sorted = nil;
-	const MSList *unsorted = linphone_core_get_chat_rooms(LC);
-	const MSList *iter = unsorted;
+- (NSMutableArray<ChatRoomListEntry *> *)sortChatRooms {
+	const MSList *iter = linphone_core_get_chat_rooms(LC);
+	NSMutableArray<ChatRoomListEntry *> *sorted = [NSMutableArray arrayWithCapacity:bctbx_list_size(iter)];
+	ChatConversationView *view = VIEW(ChatConversationView);
 
 	while (iter) {
-		// store last message in user data
 		LinphoneChatRoom *chat_room = iter->data;
 		// hide empty one-to-one chat room
 		LinphoneChatRoomCapabilitiesMask capabilities = linphone_chat_room_get_capabilities(chat_room);
-		ChatConversationView *view = VIEW(ChatConversationView);
-		if (linphone_chat_room_get_history_size(chat_room) > 0 || !(capabilities & LinphoneChatRoomCapabilitiesOneToOne) || (IPAD && view.chatRoom == chat_room)) {
-			sorted = bctbx_list_insert_sorted(sorted, chat_room, (bctbx_compare_func)sorted_history_comparison);
+		if (!(capabilities & LinphoneChatRoomCapabilitiesOneToOne) || (IPAD && view.chatRoom == chat_room) || !linphone_chat_room_is_empty(chat_room)) {
+			ChatRoomListEntry *entry = [[ChatRoomListEntry alloc] init];
+			entry.chatRoom = chat_room;
+			entry.lastUpdateTime = linphone_chat_room_get_last_update_time(chat_room);
+			[sorted addObject:entry];
 		}
 		iter = iter->next;
 	}
+	// times are read once, not at each comparison
+	[sorted sortWithOptions:NSSortStable
+			usingComparator:^NSComparisonResult(id a, id b) {
+			  return compareEntries(a, b);
+			}];
 	return sorted;
 }
 
+- (ChatRoomListEntry *)entryForChatRoom:(LinphoneChatRoom *)chatRoom {
+	return chatRoom ? [entriesByChatRoom objectForKey:(__bridge id)(void *)chatRoom] : nil;
+}
+
+// the entry is found by its chat room, then its row by a binary search on the time it is sorted by
+- (NSUInteger)indexOfChatRoom:(LinphoneChatRoom *)chatRoom {
+	ChatRoomListEntry *entry = [self entryForChatRoom:chatRoom];
+	if (!entry)
+		return NSNotFound;
+	NSUInteger index = [entries indexOfObject:entry
+								inSortedRange:NSMakeRange(0, entries.count)
+									  options:NSBinarySearchingFirstEqual
+							  usingComparator:^NSComparisonResult(id a, id b) {
+								return compareEntries(a, b);
+							  }];
+	// chat rooms updated at the same time are next to each other
+	for (; index < entries.count && compareEntries(entries[index], entry) == NSOrderedSame; index++) {
+		if (entries[index] == entry)
+			return index;
+	}
+	return NSNotFound;
+}
+
+- (LinphoneChatRoom *)chatRoomAtIndex:(NSInteger)index {
+	return (index >= 0 && index < (NSInteger)entries.count) ? entries[index].chatRoom : NULL;
+}
+
+- (UIChatCellModel *)modelForEntry:(ChatRoomListEntry *)entry {
+	if (!entry.model)
+		entry.model = [[UIChatCellModel alloc] initWithChatRoom:entry.chatRoom];
+	return entry.model;
+}
+
+- (void)resetModels {
+	for (ChatRoomListEntry *entry in entries)
+		entry.model = nil;
+	[self.tableView reloadData];
+}
+
 - (void)loadData {
-	if (_data) bctbx_list_free(_data);
-	_data = [self sortChatRooms];
+	CFTimeInterval start = CACurrentMediaTime();
+	NSMapTable *previous = entriesByChatRoom;
+	entries = [self sortChatRooms];
+	entriesByChatRoom = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality
+											  valueOptions:NSPointerFunctionsStrongMemory];
+	// rows of the chat rooms which did not change since are not computed again
+	NSUInteger reused = 0;
+	for (ChatRoomListEntry *entry in entries) {
+		[entriesByChatRoom setObject:entry forKey:(__bridge id)(void *)entry.chatRoom];
+		ChatRoomListEntry *old = [previous objectForKey:(__bridge id)(void *)entry.chatRoom];
+		if (old.model && old.lastUpdateTime == entry.lastUpdateTime) {
+			entry.model = old.model;
+			reused++;
+		}
+	}
+	LOGD(@"Chat list sorted: %lu chat rooms, %lu rows kept, in %.1f ms", (unsigned long)entries.count,
+		 (unsigned long)reused, (CACurrentMediaTime() - start) * 1000);
 	[super loadData];
 
 	if (IPAD) {
-		int idx = bctbx_list_index(_data, VIEW(ChatConversationView).chatRoom);
+		NSUInteger idx = [self indexOfChatRoom:VIEW(ChatConversationView).chatRoom];
 		// if conversation view is using a chatroom that does not exist anymore, update it
-		if (idx != -1) {
+		if (idx != NSNotFound) {
 			NSIndexPath *indexPath = [NSIndexPath indexPathForRow:idx inSection:0];
 			[self.tableView selectRowAtIndexPath:indexPath animated:NO scrollPosition:UITableViewScrollPositionNone];
 		} else if (![self selectFirstRow]) {
@@ -128,6 +216,34 @@ static int sorted_history_comparison(LinphoneChatRoom *to_insert, LinphoneChatRo
 	}
 }
 
+- (void)chatRoomUpdated:(LinphoneChatRoom *)chatRoom {
+	NSUInteger index = [self indexOfChatRoom:chatRoom];
+	// not listed yet (first message of a one-to-one chat room), or selections which would not follow their rows
+	if (index == NSNotFound || self.isEditing) {
+		[self loadData];
+		return;
+	}
+
+	ChatRoomListEntry *entry = entries[index];
+	entry.lastUpdateTime = linphone_chat_room_get_last_update_time(chatRoom);
+	entry.model = [[UIChatCellModel alloc] initWithChatRoom:chatRoom];
+	[entries removeObjectAtIndex:index];
+	// ahead of the chat rooms updated at the same time, usually the top of the list
+	NSUInteger newIndex = [entries indexOfObject:entry
+								   inSortedRange:NSMakeRange(0, entries.count)
+										 options:NSBinarySearchingInsertionIndex | NSBinarySearchingFirstEqual
+								 usingComparator:^NSComparisonResult(id a, id b) {
+								   return compareEntries(a, b);
+								 }];
+	[entries insertObject:entry atIndex:newIndex];
+
+	NSIndexPath *indexPath = [NSIndexPath indexPathForRow:newIndex inSection:0];
+	if (newIndex != index)
+		[self.tableView moveRowAtIndexPath:[NSIndexPath indexPathForRow:index inSection:0] toIndexPath:indexPath];
+	UIChatCell *cell = (UIChatCell *)[self.tableView cellForRowAtIndexPath:indexPath];
+	[cell setChatRoom:chatRoom model:entry.model];
+}
+
 + (void) saveDataToUserDefaults {
 	// As extensions is disabled by default, this function takes too much CPU.
 #if 0
@@ -198,7 +314,9 @@ static int sorted_history_comparison(LinphoneChatRoom *to_insert, LinphoneChatRo
 }
 
 - (void)markCellAsRead:(LinphoneChatRoom *)chatRoom {
-	int idx = bctbx_list_index(_data, VIEW(ChatConversationView).chatRoom);
+	NSUInteger idx = [self indexOfChatRoom:VIEW(ChatConversationView).chatRoom];
+	if (idx == NSNotFound)
+		return;
 	NSIndexPath *indexPath = [NSIndexPath indexPathForRow:idx inSection:0];
 	if (IPAD) {
 		UIChatCell *cell = (UIChatCell *)[self.tableView cellForRowAtIndexPath:indexPath];
@@ -213,7 +331,7 @@ static int sorted_history_comparison(LinphoneChatRoom *to_insert, LinphoneChatRo
 }
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section {
-	return bctbx_list_size(_data);
+	return entries.count;
 }
 
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath {
@@ -223,7 +341,8 @@ static int sorted_history_comparison(LinphoneChatRoom *to_insert, LinphoneChatRo
 		cell = [[UIChatCell alloc] initWithIdentifier:kCellId];
 
 
-	[cell setChatRoom:(LinphoneChatRoom *)bctbx_list_nth_data(_data, (int)[indexPath row])];
+	ChatRoomListEntry *entry = entries[indexPath.row];
+	[cell setChatRoom:entry.chatRoom model:[self modelForEntry:entry]];
 	[super accessoryForCell:cell atPath:indexPath];
 	return cell;
 }
@@ -239,7 +358,7 @@ static int sorted_history_comparison(LinphoneChatRoom *to_insert, LinphoneChatRo
 	if ([self isEditing])
 		return;
 
-	LinphoneChatRoom *chatRoom = (LinphoneChatRoom *)bctbx_list_nth_data(_data, (int)[indexPath row]);
+	LinphoneChatRoom *chatRoom = [self chatRoomAtIndex:indexPath.row];
 	[PhoneMainView.instance goToChatRoom:chatRoom];
 }
 
@@ -276,14 +395,9 @@ void deletion_chat_room_state_changed(LinphoneChatRoom *cr, LinphoneChatRoomStat
 		linphone_chat_room_cbs_set_user_data(cbs, (__bridge void*)self);
 		linphone_chat_room_add_callbacks(chatRoom, cbs);
 
-		FileTransferDelegate *ftdToDelete = nil;
-		for (FileTransferDelegate *ftd in [LinphoneManager.instance fileTransferDelegates]) {
-			if (linphone_chat_message_get_chat_room(ftd.message) == chatRoom) {
-				ftdToDelete = ftd;
-				break;
-			}
+		for (FileTransferDelegate *ftd in [LinphoneManager.instance.fileTransferRegistry delegatesForChatRoom:chatRoom]) {
+			[ftd cancel];
 		}
-		[ftdToDelete cancel];
 
 		linphone_core_delete_chat_room(LC, chatRoom);
 		chatRooms = chatRooms->next;
@@ -294,7 +408,7 @@ void deletion_chat_room_state_changed(LinphoneChatRoom *cr, LinphoneChatRoomStat
 	commitEditingStyle:(UITableViewCellEditingStyle)editingStyle
 	 forRowAtIndexPath:(NSIndexPath *)indexPath {
 	if (editingStyle == UITableViewCellEditingStyleDelete) {
-		LinphoneChatRoom *chatRoom = (LinphoneChatRoom *)bctbx_list_nth_data(_data, (int)[indexPath row]);
+		LinphoneChatRoom *chatRoom = [self chatRoomAtIndex:indexPath.row];
 		NSString *msg = (LinphoneChatRoomCapabilitiesOneToOne & linphone_chat_room_get_capabilities(chatRoom))
 			? [NSString stringWithFormat:NSLocalizedString(@"Do you want to delete this conversation?", nil)]
 			: [NSString stringWithFormat:NSLocalizedString(@"Do you want to leave and delete this conversation?", nil)];
@@ -317,7 +431,7 @@ void deletion_chat_room_state_changed(LinphoneChatRoom *cr, LinphoneChatRoomStat
 	}];
 	NSArray *copy = [[NSArray alloc] initWithArray:self.selectedItems];
 	for (NSIndexPath *indexPath in copy) {
-		LinphoneChatRoom *chatRoom = (LinphoneChatRoom *)bctbx_list_nth_data(_data, (int)[indexPath row]);
+		LinphoneChatRoom *chatRoom = [self chatRoomAtIndex:indexPath.row];
 		_chatRooms = bctbx_list_append(_chatRooms, chatRoom);
 	}
 	[self deleteChatRooms];
@@ -53,7 +53,11 @@
 #pragma mark - Event Functions
 
 - (void)textReceivedEvent:(NSNotification *)notif {
-	[_tableController loadData];
+	LinphoneChatRoom *room = [[notif.userInfo objectForKey:@"room"] pointerValue];
+	if (room)
+		[_tableController chatRoomUpdated:room];
+	else
+		[_tableController loadData];
 }
 
 - (void)callUpdateEvent:(NSNotification *)notif {
@@ -113,7 +117,7 @@ static UICompositeViewDescription *compositeDescription = nil;
 	BOOL group = false;
 	NSArray *copy = [[NSArray alloc] initWithArray:_tableController.selectedItems];
 	for (NSIndexPath *indexPath in copy) {
-		LinphoneChatRoom *chatRoom = (LinphoneChatRoom *)bctbx_list_nth_data(_tableController.data, (int)[indexPath row]);
+		LinphoneChatRoom *chatRoom = [_tableController chatRoomAtIndex:indexPath.row];
 		if (LinphoneChatRoomCapabilitiesConference & linphone_chat_room_get_capabilities(chatRoom)) {
 			group = true;
 			break;
@@ -39,7 +39,14 @@
 
 - (void)setAvatar:(UIImage *)avatar;
 - (UIImage *)avatar;
+/* encoded avatar, fetched from the contact store when it was not loaded. Can be called from any thread */
+- (NSData *)avatarData;
 - (NSString *)displayName;
+/* lowercased domains of the SIP addresses. They are parsed again only once the addresses changed. Must be called from
+ * the main thread: parsing goes through the core. Elsewhere, only the domains already set are returned */
+- (NSSet<NSString *> *)sipDomains;
+/* domains already parsed from the current SIP addresses */
+- (void)setSipDomains:(NSSet<NSString *> *)domains;
 
 - (instancetype)initWithCNContact:(CNContact *)contact;
 - (instancetype)initWithFriend:(LinphoneFriend *) friend;
@@ -20,7 +20,13 @@
 #import "Contact.h"
 #import "ContactsListView.h"
 
-@implementation Contact
+@implementation Contact {
+	// set by the user, not saved yet
+	UIImage *_editedAvatar;
+	// the SIP addresses the domains were parsed from
+	NSArray<NSString *> *_sipDomainsAddresses;
+	NSSet<NSString *> *_sipDomains;
+}
 
 - (instancetype)initWithCNContact:(CNContact *)acncontact {
   return [self initWithPerson:acncontact andFriend:NULL];
@@ -110,14 +116,53 @@
 }
 
 #pragma mark - Getters
+- (NSData *)avatarData {
+	if (!_person)
+		return nil;
+	// the address book is loaded without the avatars, they are fetched when needed
+	if ([_person isKeyAvailable:CNContactImageDataKey])
+		return _person.imageData;
+	if ([_person isKeyAvailable:CNContactImageDataAvailableKey] && !_person.imageDataAvailable)
+		return nil;
+	return [ContactAvatarCache.sharedCache avatarDataForIdentifier:_identifier];
+}
+
 - (UIImage *)avatar {
-	@try {
-		if (_person)
-			return [UIImage imageWithData:_person.imageData];
-	} @catch (NSException *e) {
-		LOGE(@"CNContact imageData CNPropertyNotFetchedException : %@", e);
+	if (_editedAvatar)
+		return _editedAvatar;
+	NSData *data = [self avatarData];
+	return data ? [UIImage imageWithData:data] : nil;
+}
+
+- (NSSet<NSString *> *)sipDomains {
+	@synchronized(self) {
+		// comparing a few strings is much cheaper than parsing them, and catches every way the array is changed
+		if (_sipDomains && [_sipDomainsAddresses isEqualToArray:_sipAddresses])
+			return _sipDomains;
+		// liblinphone is only used from the main thread, keep to what keysForContacts: filled in
+		if (!NSThread.isMainThread)
+			return _sipDomains ?: [NSSet set];
+		NSMutableSet<NSString *> *domains = [NSMutableSet set];
+		for (NSString *sip in _sipAddresses) {
+			LinphoneAddress *address = linphone_core_interpret_url(LC, sip.UTF8String);
+			if (!address)
+				continue;
+			const char *domain = linphone_address_get_domain(address);
+			if (domain)
+				[domains addObject:[NSString stringWithUTF8String:domain].lowercaseString];
+			linphone_address_unref(address);
+		}
+		_sipDomainsAddresses = [_sipAddresses copy];
+		_sipDomains = domains;
+		return domains;
+	}
+}
+
+- (void)setSipDomains:(NSSet<NSString *> *)domains {
+	@synchronized(self) {
+		_sipDomainsAddresses = [_sipAddresses copy];
+		_sipDomains = [domains copy];
 	}
-	return nil;
 }
 
 - (NSString *)displayName {
@@ -170,6 +215,8 @@
 
 	NSData *imageAvatar = UIImageJPEGRepresentation(avatar, 0.9f);
 	[_person setValue:imageAvatar forKey:CNContactImageDataKey];
+	_editedAvatar = avatar;
+	[ContactAvatarCache.sharedCache removeThumbnailForIdentifier:_identifier];
 }
 
 - (void)setFirstName:(NSString *)firstName {
@@ -18,19 +18,44 @@
  */
 
 #import "ContactsListTableView.h"
+#import "ContactSearchIndex.h"
 #import "UIContactCell.h"
 #import "LinphoneManager.h"
 #import "PhoneMainView.h"
 #import "Utils.h"
 
-@implementation ContactsListTableView
-NSArray *sortedAddresses;
+// beyond this, the table is reloaded rather than animated
+#define CONTACTS_LIST_MAX_ANIMATED_CHANGES 100
+
+// what a contact is sorted and sectioned by, computed once per load
+@interface ContactListEntry : NSObject
+@property(strong) Contact *contact;
+@property(strong) NSString *name;
+// display name transliterated to ASCII, lowercased
+@property(strong) NSString *sortKey;
+@property(strong) NSString *section;
+@end
+
+@implementation ContactListEntry
+@end
+
+@implementation ContactsListTableView {
+	// the contacts the filters let through at the last load, sorted. Only used on contactsListQueue
+	ContactSearchIndex *searchIndex;
+	// bumped each time the table content is replaced, a load finishing after a newer one is dropped
+	NSUInteger loadGeneration;
+	// the table shows search results
+	BOOL searching;
+	// the address book changed while loading
+	BOOL reloadPending;
+	// contact -> name it is displayed with, as of the last load applied to the table
+	NSMapTable<Contact *, NSString *> *displayedNames;
+}
 
 #pragma mark - Lifecycle Functions
 
 - (void)initContactsTableViewController {
 	addressBookMap = [[OrderedDictionary alloc] init];
-	sortedAddresses = [[NSArray alloc] init];
         [NSNotificationCenter.defaultCenter
             addObserver:self
                selector:@selector(onAddressBookUpdate:)
@@ -44,7 +69,11 @@ NSArray *sortedAddresses;
 }
 
 - (void)onAddressBookUpdate:(NSNotification *)k {
-	if (!_ongoing && ((PhoneMainView.instance.currentView == ContactsListView.compositeViewDescription) || (IPAD && PhoneMainView.instance.currentView == ContactDetailsView.compositeViewDescription))) {
+	if (_ongoing) {
+		reloadPending = TRUE;
+		return;
+	}
+	if (((PhoneMainView.instance.currentView == ContactsListView.compositeViewDescription) || (IPAD && PhoneMainView.instance.currentView == ContactDetailsView.compositeViewDescription))) {
 		[self loadData];
 	}
 }
@@ -111,225 +140,263 @@ static int ms_strcmpfuz(const char *fuzzy_word, const char *sentence) {
 	return (int)(within_sentence != NULL ? 0 : fuzzy_word + strlen(fuzzy_word) - c);
 }
 
-- (NSString *)displayNameForContact:(Contact *)person {
-	NSString *name = person.displayName;
-	if (name != nil && [name length] > 0 && ![name isEqualToString:NSLocalizedString(@"Unknown", nil)]) {
-		// Add the contact only if it fuzzy match filter too (if any)
-		if ([ContactSelection getNameOrEmailFilter] == nil ||
-			(ms_strcmpfuz([[[ContactSelection getNameOrEmailFilter] lowercaseString] UTF8String],
-						  [[name lowercaseString] UTF8String]) == 0)) {
-
-			// Sort contacts by first letter. We need to translate the name to ASCII first, because of UTF-8
-			// issues. For instance expected order would be:  Alberta(A tilde) before ASylvano.
-			NSData *name2ASCIIdata = [name dataUsingEncoding:NSASCIIStringEncoding allowLossyConversion:YES];
-			NSString *name2ASCII = [[NSString alloc] initWithData:name2ASCIIdata encoding:NSASCIIStringEncoding];
-			return name2ASCII;
-		}
-	}
-	return nil;
+static dispatch_queue_t contactsListQueue() {
+	static dispatch_queue_t queue;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+	  queue = dispatch_queue_create("org.linphone.contactslist", DISPATCH_QUEUE_SERIAL);
+	});
+	return queue;
+}
+
+// contacts without a name are not listed
+static ContactListEntry *entryForContact(Contact *contact, NSString *name) {
+	if (name.length == 0 || [name isEqualToString:NSLocalizedString(@"Unknown", nil)])
+		return nil;
+
+	// Sort contacts by first letter. We need to translate the name to ASCII first, because of UTF-8
+	// issues. For instance expected order would be:  Alberta(A tilde) before ASylvano.
+	NSData *name2ASCIIdata = [name dataUsingEncoding:NSASCIIStringEncoding allowLossyConversion:YES];
+	NSString *name2ASCII = [[NSString alloc] initWithData:name2ASCIIdata encoding:NSASCIIStringEncoding];
+	if (name2ASCII.length == 0)
+		return nil;
+
+	ContactListEntry *entry = [[ContactListEntry alloc] init];
+	entry.contact = contact;
+	entry.name = name;
+	entry.sortKey = name2ASCII.lowercaseString;
+	unichar firstChar = [entry.sortKey characterAtIndex:0];
+	entry.section = (firstChar < 'a' || firstChar > 'z') ? @"#" : [NSString stringWithFormat:@"%C", (unichar)(firstChar - 'a' + 'A')];
+	return entry;
+}
+
+static BOOL shouldListContact(Contact *contact, BOOL filtered, BOOL emailFilter) {
+	// Do not add the contact directly if we set some filter
+	if (!filtered || [FastAddressBook contactHasValidSipDomain:contact])
+		return TRUE;
+	if (contact.friend &&
+		linphone_presence_model_get_basic_status(linphone_friend_get_presence_model(contact.friend)) ==
+			LinphonePresenceBasicStatusOpen)
+		return TRUE;
+	// Add this contact if it has an email
+	return emailFilter && contact.emails.count > 0;
 }
 
 - (void)loadData {
-	_ongoing = TRUE;
 	LOGI(@"====>>>> Load contact list - Start");
 	NSString* previous = [PhoneMainView.instance  getPreviousViewName];
-	addressBookMap = [LinphoneManager.instance getLinphoneManagerAddressBookMap];
+	OrderedDictionary *cachedMap = [LinphoneManager.instance getLinphoneManagerAddressBookMap];
 	BOOL updated = [LinphoneManager.instance getContactsUpdated];
-	if(([previous isEqualToString:@"ContactsDetailsView"] && updated) || updated || [addressBookMap count] == 0){
-		[LinphoneManager.instance setContactsUpdated:FALSE];
-		@synchronized(addressBookMap) {
-			NSDictionary *allContacts = [[NSMutableDictionary alloc] initWithDictionary:LinphoneManager.instance.fastAddressBook.addressBookMap];
-			sortedAddresses = [[LinphoneManager.instance.fastAddressBook.addressBookMap allKeys] sortedArrayUsingComparator:^NSComparisonResult(id a, id b) {
-				Contact* first =  [allContacts objectForKey:a];
-				Contact* second =  [allContacts objectForKey:b];
-				if([[first.firstName lowercaseString] compare:[second.firstName lowercaseString]] == NSOrderedSame)
-					return [[first.lastName lowercaseString] compare:[second.lastName lowercaseString]];
-				else
-					return [[first.firstName lowercaseString] compare:[second.firstName lowercaseString]];
-			}];
-			
-			
-			LOGI(@"====>>>> Load contact list - Start 2 !!");
-			//Set all contacts from ContactCell to nil
-			for (NSInteger j = 0; j < [self.tableView numberOfSections]; ++j){
-				for (NSInteger i = 0; i < [self.tableView numberOfRowsInSection:j]; ++i)
-				{
-					[[self.tableView cellForRowAtIndexPath:[NSIndexPath indexPathForRow:i inSection:j]] setContact:nil];
-				}
-			}
-			
-			// Reset Address book
-			[addressBookMap removeAllObjects];
-			for (NSString *addr in sortedAddresses) {
-				Contact *contact = nil;
-				@synchronized(LinphoneManager.instance.fastAddressBook.addressBookMap) {
-					contact = [LinphoneManager.instance.fastAddressBook.addressBookMap objectForKey:addr];
-				}
-				BOOL add = true;
-				// Do not add the contact directly if we set some filter
-				if ([ContactSelection getSipFilter] ||
-					[ContactSelection emailFilterEnabled]) {
-				  add = false;
-				}
-				if ([FastAddressBook contactHasValidSipDomain:contact]) {
-				  add = true;
-				}else if (contact.friend &&
-					linphone_presence_model_get_basic_status(
-						linphone_friend_get_presence_model(
-							contact.friend)) ==
-						LinphonePresenceBasicStatusOpen) {
-				  add = true;
-				}
-
-				if (!add && [ContactSelection emailFilterEnabled]) {
-				  // Add this contact if it has an email
-				  add = (contact.emails.count > 0);
-				}
+	searching = FALSE;
+	if(!(([previous isEqualToString:@"ContactsDetailsView"] && updated) || updated || [cachedMap count] == 0)){
+		loadGeneration++;
+		addressBookMap = cachedMap;
+		LOGI(@"====>>>> Load contact list - End");
+		[super loadData];
+		return;
+	}
+	[LinphoneManager.instance setContactsUpdated:FALSE];
+	_ongoing = TRUE;
+	reloadPending = FALSE;
+	NSUInteger generation = ++loadGeneration;
+
+	// filters are read here, they belong to the main thread
+	BOOL emailFilter = [ContactSelection emailFilterEnabled];
+	BOOL filtered = ([ContactSelection getSipFilter] != nil) || emailFilter;
+	NSString *nameFilter = [[ContactSelection getNameOrEmailFilter] lowercaseString];
+	// a snapshot, it does not change while we go through it
+	NSDictionary *allContacts = LinphoneManager.instance.fastAddressBook.addressBookMap;
+	// a contact is registered under each of its addresses
+	NSSet<Contact *> *uniqueContacts = [NSSet setWithArray:allContacts.allValues];
+	// presences, SIP domains and friend names come from liblinphone, they are read here. The domains were parsed when
+	// the contacts were loaded, this is only a lookup
+	NSMutableArray<Contact *> *contacts = [NSMutableArray arrayWithCapacity:uniqueContacts.count];
+	NSMutableArray<NSString *> *names = [NSMutableArray arrayWithCapacity:uniqueContacts.count];
+	for (Contact *contact in uniqueContacts) {
+		if (!shouldListContact(contact, filtered, emailFilter))
+			continue;
+		[contacts addObject:contact];
+		[names addObject:contact.displayName ?: @""];
+	}
 
-				NSMutableString *name = [self displayNameForContact:contact] ? [[NSMutableString alloc] initWithString: [self displayNameForContact:contact]] : nil;
-				if (add && name != nil) {
-					NSString *firstChar = [[name substringToIndex:1] uppercaseString];
-					// Put in correct subAr
-					if ([firstChar characterAtIndex:0] < 'A' || [firstChar characterAtIndex:0] > 'Z') {
-						firstChar = @"#";
-					}
-					NSMutableArray *subAr = [addressBookMap objectForKey:firstChar];
-					if (subAr == nil) {
-						subAr = [[NSMutableArray alloc] init];
-						[addressBookMap insertObject:subAr forKey:firstChar selector:@selector(caseInsensitiveCompare:)];
-					}
-					NSUInteger idx = [subAr indexOfObject:contact inSortedRange:(NSRange){0, subAr.count} options:NSBinarySearchingInsertionIndex usingComparator:^NSComparisonResult( Contact *_Nonnull obj1, Contact *_Nonnull obj2) {
-							return [[self displayNameForContact:obj1] compare:[self displayNameForContact:obj2] options:NSCaseInsensitiveSearch];
-					}];
-					if (![subAr containsObject:contact]) {
-						[subAr insertObject:contact atIndex:idx];
-					}
+	dispatch_async(contactsListQueue(), ^{
+	  CFTimeInterval start = CACurrentMediaTime();
+	  NSMutableArray<ContactListEntry *> *entries = [NSMutableArray arrayWithCapacity:contacts.count];
+	  for (NSUInteger i = 0; i < contacts.count; i++) {
+		  ContactListEntry *entry = entryForContact(contacts[i], names[i]);
+		  if (entry)
+			  [entries addObject:entry];
+	  }
+	  [entries sortUsingComparator:^NSComparisonResult(ContactListEntry *a, ContactListEntry *b) {
+		NSComparisonResult result = [a.section compare:b.section];
+		return result != NSOrderedSame ? result : [a.sortKey compare:b.sortKey];
+	  }];
+
+	  NSMutableArray<Contact *> *sortedContacts = [NSMutableArray arrayWithCapacity:entries.count];
+	  NSMutableArray<NSString *> *sortedNames = [NSMutableArray arrayWithCapacity:entries.count];
+	  for (ContactListEntry *entry in entries) {
+		  [sortedContacts addObject:entry.contact];
+		  [sortedNames addObject:entry.name];
+	  }
+	  searchIndex = [[ContactSearchIndex alloc] initWithContacts:sortedContacts names:sortedNames];
+
+	  NSMapTable<Contact *, NSString *> *names = [NSMapTable strongToStrongObjectsMapTable];
+	  for (ContactListEntry *entry in entries)
+		  [names setObject:entry.name forKey:entry.contact];
+
+	  // sorted already: sections are appended in order, and so are the contacts of each section
+	  OrderedDictionary *sections = [[OrderedDictionary alloc] init];
+	  NSMutableArray *subAr = nil;
+	  NSString *section = nil;
+	  NSUInteger listed = 0;
+	  for (ContactListEntry *entry in entries) {
+		  // Add the contact only if it fuzzy match filter too (if any)
+		  if (nameFilter && ms_strcmpfuz(nameFilter.UTF8String, entry.name.lowercaseString.UTF8String) != 0)
+			  continue;
+		  listed++;
+		  if (![section isEqualToString:entry.section]) {
+			  section = entry.section;
+			  subAr = [[NSMutableArray alloc] init];
+			  [sections insertObject:subAr forKey:section atIndex:sections.count];
+		  }
+		  [subAr addObject:entry.contact];
+	  }
+	  LOGI(@"====>>>> Contact list built in %.0f ms: %lu contacts, %lu listed in %lu sections",
+		   (CACurrentMediaTime() - start) * 1000, (unsigned long)entries.count, (unsigned long)listed,
+		   (unsigned long)sections.count);
+
+	  dispatch_async(dispatch_get_main_queue(), ^{
+		if (generation == loadGeneration) {
+			[self applySections:sections names:names];
+			[LinphoneManager.instance setLinphoneManagerAddressBookMap:addressBookMap];
+			if (IPAD) {
+				if (!([self totalNumberOfItems] > 0)) {
+					ContactDetailsView *view = VIEW(ContactDetailsView);
+					[view setContact:nil];
 				}
 			}
-			// since we refresh the tableview, we must perform this on main
-			// thread
-			dispatch_async(dispatch_get_main_queue(), ^(void) {
-				if (IPAD) {
-					if (!([self totalNumberOfItems] > 0)) {
-						ContactDetailsView *view = VIEW(ContactDetailsView);
-						[view setContact:nil];
-					}
-				}
-			});
+			LOGI(@"====>>>> Load contact list - End");
+		} else if (searching) {
+			// the search ran on the previous index
+			[self loadSearchedData];
+		}
+		_ongoing = FALSE;
+		if (reloadPending) {
+			reloadPending = FALSE;
+			[self onAddressBookUpdate:nil];
 		}
-		[LinphoneManager.instance setLinphoneManagerAddressBookMap:addressBookMap];
+	  });
+	});
+}
+
+// Rows of a section which are neither inserted nor deleted keep their order, contacts are only ever added or removed.
+// A contact edited in place may have moved though, the table is reloaded then. When it kept its place, its row is
+// reloaded if its name changed.
+static BOOL diffSection(NSArray *oldRows, NSArray *newRows, NSInteger oldSection, NSInteger newSection,
+						NSMapTable *oldNames, NSMapTable *newNames, NSMutableArray<NSIndexPath *> *deleted,
+						NSMutableArray<NSIndexPath *> *inserted, NSMutableArray<NSIndexPath *> *reloaded) {
+	NSSet *oldSet = [NSSet setWithArray:oldRows];
+	NSSet *newSet = [NSSet setWithArray:newRows];
+	NSMutableArray *oldKept = [NSMutableArray arrayWithCapacity:oldRows.count];
+	NSMutableArray *newKept = [NSMutableArray arrayWithCapacity:newRows.count];
+	for (NSInteger row = 0; row < (NSInteger)oldRows.count; row++) {
+		Contact *contact = oldRows[row];
+		if (![newSet containsObject:contact]) {
+			[deleted addObject:[NSIndexPath indexPathForRow:row inSection:oldSection]];
+			continue;
+		}
+		[oldKept addObject:contact];
+		NSString *oldName = [oldNames objectForKey:contact];
+		if (oldName && ![oldName isEqualToString:[newNames objectForKey:contact]])
+			[reloaded addObject:[NSIndexPath indexPathForRow:row inSection:oldSection]];
 	}
-	LOGI(@"====>>>> Load contact list - End");
-	[super loadData];
-	_ongoing = FALSE;
+	for (NSInteger row = 0; row < (NSInteger)newRows.count; row++) {
+		if ([oldSet containsObject:newRows[row]])
+			[newKept addObject:newRows[row]];
+		else
+			[inserted addObject:[NSIndexPath indexPathForRow:row inSection:newSection]];
+	}
+	return [oldKept isEqualToArray:newKept];
+}
+
+- (void)applySections:(OrderedDictionary *)sections names:(NSMapTable<Contact *, NSString *> *)names {
+	OrderedDictionary *oldSections = addressBookMap;
+	NSMapTable<Contact *, NSString *> *oldNames = displayedNames;
+	addressBookMap = sections;
+	displayedNames = names;
+	// selections are index paths, they would not follow their rows
+	if (oldSections.count == 0 || self.isEditing || !self.tableView.window) {
+		[super loadData];
+		return;
+	}
+
+	NSArray *oldKeys = oldSections.allKeys;
+	NSArray *newKeys = sections.allKeys;
+	NSMutableIndexSet *deletedSections = [NSMutableIndexSet indexSet];
+	NSMutableIndexSet *insertedSections = [NSMutableIndexSet indexSet];
+	NSMutableArray<NSIndexPath *> *deletedRows = [NSMutableArray array];
+	NSMutableArray<NSIndexPath *> *insertedRows = [NSMutableArray array];
+	NSMutableArray<NSIndexPath *> *reloadedRows = [NSMutableArray array];
+	BOOL ordered = TRUE;
+	for (NSUInteger i = 0; i < oldKeys.count; i++) {
+		if (!sections[oldKeys[i]])
+			[deletedSections addIndex:i];
+	}
+	for (NSUInteger i = 0; i < newKeys.count && ordered; i++) {
+		NSUInteger oldIndex = [oldSections indexOfKey:newKeys[i]];
+		if (oldIndex == NSNotFound)
+			[insertedSections addIndex:i];
+		else
+			ordered = diffSection(oldSections[newKeys[i]], sections[newKeys[i]], oldIndex, i, oldNames, names,
+								  deletedRows, insertedRows, reloadedRows);
+	}
+	NSUInteger changes = deletedSections.count + insertedSections.count + deletedRows.count + insertedRows.count +
+						 reloadedRows.count;
+	LOGI(@"====>>>> Contact list diff: %lu sections removed, %lu added, %lu rows removed, %lu added, %lu reloaded",
+		 (unsigned long)deletedSections.count, (unsigned long)insertedSections.count, (unsigned long)deletedRows.count,
+		 (unsigned long)insertedRows.count, (unsigned long)reloadedRows.count);
+	if (!ordered || changes > CONTACTS_LIST_MAX_ANIMATED_CHANGES) {
+		[super loadData];
+		return;
+	}
+	if (changes == 0)
+		return;
+
+	[self.tableView beginUpdates];
+	[self.tableView deleteSections:deletedSections withRowAnimation:UITableViewRowAnimationFade];
+	[self.tableView insertSections:insertedSections withRowAnimation:UITableViewRowAnimationFade];
+	[self.tableView deleteRowsAtIndexPaths:deletedRows withRowAnimation:UITableViewRowAnimationFade];
+	[self.tableView insertRowsAtIndexPaths:insertedRows withRowAnimation:UITableViewRowAnimationFade];
+	[self.tableView reloadRowsAtIndexPaths:reloadedRows withRowAnimation:UITableViewRowAnimationNone];
+	[self.tableView endUpdates];
+	[self.tableView reloadSectionIndexTitles];
+	self.emptyView.hidden = self.editButton.enabled = ([self totalNumberOfItems] > 0);
 }
 
 - (void)loadSearchedData {
 	LOGI(@"Load search contact list");
-	@synchronized(addressBookMap) {
-		//Set all contacts from ContactCell to nil
-		for (NSInteger j = 0; j < [self.tableView numberOfSections]; ++j)
-		{
-			for (NSInteger i = 0; i < [self.tableView numberOfRowsInSection:j]; ++i)
-			{
-				[[self.tableView cellForRowAtIndexPath:[NSIndexPath indexPathForRow:i inSection:j]] setContact:nil];
+	searching = TRUE;
+	NSUInteger generation = ++loadGeneration;
+	NSString *filter = [ContactSelection getNameOrEmailFilter];
+	dispatch_async(contactsListQueue(), ^{
+	  NSArray<Contact *> *results = [searchIndex search:filter] ?: @[];
+	  dispatch_async(dispatch_get_main_queue(), ^{
+		// a key was typed meanwhile
+		if (generation != loadGeneration)
+			return;
+		OrderedDictionary *sections = [[OrderedDictionary alloc] init];
+		[sections setObject:[results mutableCopy] forKey:@""];
+		addressBookMap = sections;
+		[super loadData];
+
+		if (IPAD) {
+			if (!([self totalNumberOfItems] > 0)) {
+				ContactDetailsView *view = VIEW(ContactDetailsView);
+				[view setContact:nil];
 			}
 		}
-		// Reset Address book
-		[addressBookMap removeAllObjects];
-		NSMutableArray *subAr = [NSMutableArray new];
-		NSMutableArray *subArBegin = [NSMutableArray new];
-		NSMutableArray *subArContain = [NSMutableArray new];
-		[addressBookMap insertObject:subAr forKey:@"" selector:@selector(caseInsensitiveCompare:)];
-		for (NSString *addr in sortedAddresses) {
-                  @synchronized(
-                      LinphoneManager.instance.fastAddressBook.addressBookMap) {
-                    Contact *contact =
-                        [LinphoneManager.instance.fastAddressBook.addressBookMap
-                            objectForKey:addr];
-
-                    BOOL add = true;
-                    // Do not add the contact directly if we set some filter
-                    if ([ContactSelection getSipFilter] ||
-                        [ContactSelection emailFilterEnabled]) {
-                      add = false;
-                    }
-                    NSString *filter = [ContactSelection getNameOrEmailFilter];
-                    if ([FastAddressBook contactHasValidSipDomain:contact]) {
-                      add = true;
-                    }
-                    if (contact.friend &&
-                        linphone_presence_model_get_basic_status(
-                            linphone_friend_get_presence_model(
-                                contact.friend)) ==
-                            LinphonePresenceBasicStatusOpen) {
-                      add = true;
-                    }
-
-                    if (!add && [ContactSelection emailFilterEnabled]) {
-                      // Add this contact if it has an email
-                      add = (contact.emails.count > 0);
-                    }
-                    NSInteger idx_begin = -1;
-                    NSInteger idx_sort = -1;
-                    NSMutableString *name =
-                        [self displayNameForContact:contact]
-                            ? [[NSMutableString alloc]
-                                  initWithString:
-                                      [self displayNameForContact:contact]]
-                            : nil;
-                    if (add && name != nil) {
-                      if ([[contact displayName]
-                              rangeOfString:filter
-                                    options:NSCaseInsensitiveSearch]
-                              .location == 0) {
-                        if (![subArBegin containsObject:contact]) {
-                          idx_begin = idx_begin + 1;
-                          [subArBegin insertObject:contact atIndex:idx_begin];
-                        }
-                      } else if ([[contact displayName]
-                                     rangeOfString:filter
-                                           options:NSCaseInsensitiveSearch]
-                                     .location != NSNotFound) {
-                        if (![subArContain containsObject:contact]) {
-                          idx_sort = idx_sort + 1;
-                          [subArContain insertObject:contact atIndex:idx_sort];
-                        }
-                      }
-                    }
-                  }
-                }
-                [subArBegin
-                    sortUsingComparator:^NSComparisonResult(
-                        Contact *_Nonnull obj1, Contact *_Nonnull obj2) {
-                      return [[self displayNameForContact:obj1]
-                          compare:[self displayNameForContact:obj2]
-                          options:NSCaseInsensitiveSearch];
-                    }];
-
-                [subArContain
-                    sortUsingComparator:^NSComparisonResult(
-                        Contact *_Nonnull obj1, Contact *_Nonnull obj2) {
-                      return [[self displayNameForContact:obj1]
-                          compare:[self displayNameForContact:obj2]
-                          options:NSCaseInsensitiveSearch];
-                    }];
-
-                [subAr addObjectsFromArray:subArBegin];
-                [subAr addObjectsFromArray:subArContain];
-                [super loadData];
-
-                // since we refresh the tableview, we must perform this on main
-                // thread
-                dispatch_async(dispatch_get_main_queue(), ^(void) {
-                  if (IPAD) {
-                    if (!([self totalNumberOfItems] > 0)) {
-                      ContactDetailsView *view = VIEW(ContactDetailsView);
-                      [view setContact:nil];
-                    }
-                  }
-                });
-        }
+	  });
+	});
 }
 
 
@@ -356,8 +423,14 @@ static int ms_strcmpfuz(const char *fuzzy_word, const char *sentence) {
 	NSMutableArray *subAr = [addressBookMap objectForKey:[addressBookMap keyAtIndex:[indexPath section]]];
 	Contact *contact = subAr[indexPath.row];
 
-	// Cached avatar
-	UIImage *image = [FastAddressBook imageForContact:contact];
+	// Cached avatar, the placeholder is shown until it is ready
+	__weak UIContactCell *weakCell = cell;
+	UIImage *image = [FastAddressBook thumbnailForContact:contact
+													side:cell.avatarImage.bounds.size.width
+											  completion:^(UIImage *thumbnail) {
+												if (weakCell.contact == contact)
+													[weakCell.avatarImage setImage:thumbnail bordered:NO withRoundedRadius:YES];
+											  }];
 	[cell.avatarImage setImage:image bordered:NO withRoundedRadius:YES];
 	[cell setContact:contact];
 	[super accessoryForCell:cell atPath:indexPath];
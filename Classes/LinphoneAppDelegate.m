@@ -89,15 +89,6 @@
 	LinphoneManager *instance = LinphoneManager.instance;
 	[instance becomeActive];
 
-	if (instance.fastAddressBook.needToUpdate) {
-		//Update address book for external changes
-		if (PhoneMainView.instance.currentView == ContactsListView.compositeViewDescription || PhoneMainView.instance.currentView == ContactDetailsView.compositeViewDescription) {
-			[PhoneMainView.instance changeCurrentView:DialerView.compositeViewDescription];
-		}
-                [instance.fastAddressBook fetchContactsInBackGroundThread];
-                instance.fastAddressBook.needToUpdate = FALSE;
-        }
-
         LinphoneCall *call = linphone_core_get_current_call(LC);
 
         if (call) {
@@ -241,6 +232,10 @@
 
 	LinphoneManager *instance = [LinphoneManager instance];
 	//init logs asap
+	[Log configureOutputWithCapacity:[instance lpConfigIntForKey:@"log_buffer_size" inSection:@"app" withDefault:4096]
+					  overflowPolicy:[instance lpConfigBoolForKey:@"log_buffer_block_when_full" inSection:@"app"]
+										 ? LogSinkOverflowBlock
+										 : LogSinkOverflowDrop];
 	[Log enableLogs:[[LinphoneManager instance] lpConfigIntForKey:@"debugenable_preference"]];
 	
 	//Starting with iOS 13, the CNCopyCurrentNetworkInfo API will no longer return valid Wi-Fi SSID and BSSID information.
@@ -332,6 +327,7 @@
 	}
 
 	[LinphoneManager.instance destroyLinphoneCore];
+	[Log flush];
 }
 
 - (BOOL)handleShortcut:(UIApplicationShortcutItem *)shortcutItem {
@@ -336,7 +336,7 @@
 	// chat section
 	{
 		[self setCString:linphone_core_get_file_transfer_server(LC) forKey:@"file_transfer_server_url_preference"];
-        int maxSize = linphone_core_get_max_size_for_auto_download_incoming_files(LC);
+        int maxSize = [lm autoDownloadMaxSize];
         [self setObject:maxSize==0 ? @"Always" : (maxSize==-1 ? @"Nerver" : @"Customize") forKey:@"auto_download_mode"];
         [self setInteger:maxSize forKey:@"auto_download_incoming_files_max_size"];        
 	}
@@ -776,7 +776,7 @@
         } else {
             maxSize = [[self stringForKey:@"auto_download_incoming_files_max_size"] intValue];
         }
-        linphone_core_set_max_size_for_auto_download_incoming_files(LC, maxSize);
+        [lm lpConfigSetInt:maxSize forKey:@"auto_download_max_size_preference"];
         [lm lpConfigSetString:[self stringForKey:@"auto_download_mode"] forKey:@"auto_download_mode"];
 
 		// network section
@@ -22,6 +22,7 @@
 #import <AudioToolbox/AudioToolbox.h>
 #import <Photos/Photos.h>
 #import <CoreTelephony/CTCallCenter.h>
+#import <CoreTelephony/CTTelephonyNetworkInfo.h>
 
 #import <sqlite3.h>
 
@@ -34,6 +35,14 @@
 #include "linphone/linphonecore.h"
 #include "bctoolbox/list.h"
 #import "OrderedDictionary.h"
+#import "CoreScheduler.h"
+#import "CoreNotificationCoalescer.h"
+#import "MessageAppDataCache.h"
+#import "MessageLayoutCache.h"
+#import "ContactAvatarCache.h"
+#import "FileTransferRegistry.h"
+#import "FileTransferScheduler.h"
+#import "DateFormatterCache.h"
 
 #import "linphoneapp-Swift.h"
 
@@ -86,7 +95,6 @@ typedef struct _LinphoneManagerSounds {
 	SCNetworkReachabilityRef proxyReachability;
 
 @private
-	NSTimer* mIterateTimer;
         NSMutableArray*  pushCallIDs;
 
 	UIBackgroundTaskIdentifier pausedCallBgTask;
@@ -95,6 +103,8 @@ typedef struct _LinphoneManagerSounds {
 	UIBackgroundTaskIdentifier pushBgTaskCall;
 	UIBackgroundTaskIdentifier pushBgTaskMsg;
 	CTCallCenter* mCallCenter;
+	CTTelephonyNetworkInfo *telephonyNetworkInfo;
+	SCNetworkReachabilityRef defaultRouteReachability;
     NSDate *mLastKeepAliveDate;
 @public
     CallContext currentCallContextBeforeGoingBackground;
@@ -103,6 +113,8 @@ typedef struct _LinphoneManagerSounds {
 #ifdef DEBUG
 + (void)instanceRelease;
 #endif
+/* liblinphone is only used from the main thread: the core is iterated there (see CoreScheduler) and its callbacks are
+ * called there. Background queues work on snapshots taken on the main thread and hand their results back to it. */
 + (LinphoneCore*) getLc;
 + (BOOL)runningOnIpad;
 + (BOOL)isNotIphone3G;
@@ -142,6 +154,7 @@ typedef struct _LinphoneManagerSounds {
 - (void)call:(const LinphoneAddress *)address;
 
 +(id)getMessageAppDataForKey:(NSString*)key inMessage:(LinphoneChatMessage*)msg;
++(NSDictionary *)getMessageAppData:(LinphoneChatMessage*)msg;
 +(void)setValueInMessageAppData:(id)value forKey:(NSString*)key inMessage:(LinphoneChatMessage*)msg;
 
 - (void)lpConfigSetString:(NSString*)value forKey:(NSString*)key;
@@ -165,6 +178,9 @@ typedef struct _LinphoneManagerSounds {
 - (BOOL)lpConfigBoolForKey:(NSString *)key withDefault:(BOOL)value;
 - (BOOL)lpConfigBoolForKey:(NSString *)key inSection:(NSString *)section withDefault:(BOOL)value;
 
+/* incoming files up to this size are downloaded on reception, 0 for any size, -1 for none */
+- (int)autoDownloadMaxSize;
+
 - (void)silentPushFailed:(NSTimer*)timer;
 
 - (void)removeAllAccounts;
@@ -205,11 +221,14 @@ typedef struct _LinphoneManagerSounds {
 @property (readonly) BOOL wasRemoteProvisioned;
 @property (readonly) LpConfig *configDb;
 @property(readonly) InAppProductsManager *iapManager;
-@property(strong, nonatomic) NSMutableArray *fileTransferDelegates;
+@property(readonly) FileTransferRegistry *fileTransferRegistry;
+@property(readonly) FileTransferScheduler *fileTransferScheduler;
 @property BOOL conf;
 @property NSDictionary *pushDict;
 @property(strong, nonatomic) OrderedDictionary *linphoneManagerAddressBookMap;
 @property (nonatomic, assign) BOOL contactsUpdated;
 @property UIImage *avatar;
+@property(readonly) CoreScheduler *coreScheduler;
+@property(readonly) CoreNotificationCoalescer *notificationCoalescer;
 
 @end
@@ -19,6 +19,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <netdb.h>
 #include <sys/sysctl.h>
 
@@ -94,6 +95,7 @@ NSString *const kLinphoneInternalChatDBFilename = @"linphone_chats.db";
 
 @interface LinphoneManager ()
 	@property(strong, nonatomic) AVAudioPlayer *messagePlayer;
+- (void)updateFileTransferNetwork;
 @end
 
 @implementation LinphoneManager
@@ -240,7 +242,20 @@ struct codec_name_pref_table codec_pref_table[] = {{"speex", 8000, "speex_8k_pre
 		_pushDict = [[NSMutableDictionary alloc] init];
 		_database = NULL;
 		_conf = FALSE;
-		_fileTransferDelegates = [[NSMutableArray alloc] init];
+		_fileTransferRegistry = [[FileTransferRegistry alloc] init];
+		_fileTransferScheduler = [[FileTransferScheduler alloc] initWithMaxConcurrentTransfers:3];
+		_notificationCoalescer = [[CoreNotificationCoalescer alloc] init];
+		// the notification is only posted while an instance of CTTelephonyNetworkInfo is alive, and by it
+		telephonyNetworkInfo = [[CTTelephonyNetworkInfo alloc] init];
+		[NSNotificationCenter.defaultCenter addObserver:self
+		 selector:@selector(radioAccessChanged:)
+		 name:CTRadioAccessTechnologyDidChangeNotification
+		 object:telephonyNetworkInfo];
+		struct sockaddr_in zeroAddress = {0};
+		zeroAddress.sin_len = sizeof(zeroAddress);
+		zeroAddress.sin_family = AF_INET;
+		defaultRouteReachability =
+			SCNetworkReachabilityCreateWithAddress(NULL, (const struct sockaddr *)&zeroAddress);
 		_linphoneManagerAddressBookMap = [[OrderedDictionary alloc] init];
 		pushCallIDs = [[NSMutableArray alloc] init];
 		_isTesting = [LinphoneManager isRunningTests];
@@ -275,6 +290,8 @@ struct codec_name_pref_table codec_pref_table[] = {{"speex", 8000, "speex_8k_pre
 
 - (void)dealloc {
 	[NSNotificationCenter.defaultCenter removeObserver:self];
+	if (defaultRouteReachability)
+		CFRelease(defaultRouteReachability);
 }
 
 #pragma mark - AddressBookMap
@@ -411,6 +428,12 @@ static int check_should_migrate_images(void *data, int argc, char **argv, char *
 		}
 		[self lpConfigSetBool:TRUE forKey:@"quality_report_migration_done"];
 	}
+	/* Auto download migration: the setting now belongs to the application, see autoDownload: */
+	if ([self lpConfigBoolForKey:@"auto_download_migration_done"] == FALSE) {
+		[self lpConfigSetInt:linphone_core_get_max_size_for_auto_download_incoming_files(LC)
+					  forKey:@"auto_download_max_size_preference"];
+		[self lpConfigSetBool:TRUE forKey:@"auto_download_migration_done"];
+	}
 	/* File transfer migration */
 	if ([self lpConfigBoolForKey:@"file_transfer_migration_done"] == FALSE) {
 		const char *newURL = "https://www.linphone.org:444/lft.php";
@@ -690,7 +713,17 @@ message:(const char *)cmessage {
 	NSDictionary *dict =
 		[NSDictionary dictionaryWithObjectsAndKeys:[NSNumber numberWithInt:state], @"state",
 		 [NSValue valueWithPointer:cfg], @"cfg", message, @"message", nil];
-	[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneRegistrationUpdate object:self userInfo:dict];
+	// only progress states are coalesced, so that no failure or success is missed by the views
+	if (cfg)
+		linphone_proxy_config_ref(cfg);
+	[_notificationCoalescer postNotificationName:kLinphoneRegistrationUpdate
+										  object:self
+										userInfo:dict
+								   coalescingKey:(state == LinphoneRegistrationProgress) ? [NSValue valueWithPointer:cfg] : nil
+										 release:^{
+										   if (cfg)
+											   linphone_proxy_config_unref(cfg);
+										 }];
 }
 
 static void linphone_iphone_registration_state(LinphoneCore *lc, LinphoneProxyConfig *cfg,
@@ -764,6 +797,23 @@ static void linphone_iphone_popup_password_request(LinphoneCore *lc, LinphoneAut
 
 #pragma mark - Text Received Functions
 
+- (int)autoDownloadMaxSize {
+	return [self lpConfigIntForKey:@"auto_download_max_size_preference" withDefault:-1];
+}
+
+// liblinphone does not download anything by itself (see finishCoreConfiguration): incoming files go through the file
+// transfer scheduler like the ones requested by the user, after them
+- (void)autoDownload:(LinphoneChatMessage *)msg {
+	if (linphone_chat_message_is_outgoing(msg) || [_fileTransferRegistry delegateForMessage:msg])
+		return;
+	int maxSize = self.autoDownloadMaxSize;
+	LinphoneContent *content = linphone_chat_message_get_file_transfer_information(msg);
+	if (maxSize < 0 || (maxSize > 0 && linphone_content_get_file_size(content) > (size_t)maxSize))
+		return;
+	FileTransferDelegate *ftd = [[FileTransferDelegate alloc] init];
+	[ftd download:msg priority:FileTransferPriorityBackground];
+}
+
 - (void)onMessageReceived:(LinphoneCore *)lc room:(LinphoneChatRoom *)room message:(LinphoneChatMessage *)msg {
 #pragma deploymate push "ignored-api-availability"
 	if (_silentPushCompletion) {
@@ -809,14 +859,14 @@ static void linphone_iphone_popup_password_request(LinphoneCore *lc, LinphoneAut
     
 	BOOL hasFile = FALSE;
 	// if auto_download is available and file is downloaded
-	if ((linphone_core_get_max_size_for_auto_download_incoming_files(LC) > -1) && linphone_chat_message_get_file_transfer_information(msg))
+	if ((self.autoDownloadMaxSize > -1) && linphone_chat_message_get_file_transfer_information(msg))
 		hasFile = TRUE;
 
 	if (!linphone_chat_message_is_file_transfer(msg) && !linphone_chat_message_is_text(msg) && !hasFile)
 		return;
     
 	if (hasFile) {
-		[ChatConversationView autoDownload:msg];
+		[self autoDownload:msg];
 	}
 
 	// Post event
@@ -827,7 +877,17 @@ static void linphone_iphone_popup_password_request(LinphoneCore *lc, LinphoneAut
 		@"call-id" : callID
 	};
 
-	[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneMessageReceived object:self userInfo:dict];
+	// a burst of messages in a room leads to a single update of the badges and of the chat list, for its last message
+	linphone_chat_room_ref(room);
+	linphone_chat_message_ref(msg);
+	[_notificationCoalescer postNotificationName:kLinphoneMessageReceived
+										  object:self
+										userInfo:dict
+								   coalescingKey:[NSValue valueWithPointer:room]
+										 release:^{
+										   linphone_chat_message_unref(msg);
+										   linphone_chat_room_unref(room);
+										 }];
 
 	if (linphone_chat_message_is_outgoing(msg))
 		return;
@@ -1076,14 +1136,18 @@ static void linphone_iphone_notify_received(LinphoneCore *lc, LinphoneEvent *lev
 friend:(LinphoneFriend *)lf
 uri:(const char *)uri
 presenceModel:(const LinphonePresenceModel *)model {
-	// Post event
+	// Post event, once per friend whatever the number of presence updates received for it. uri and model are only
+	// valid during the callback, the observers read the presence from the friend.
 	NSMutableDictionary *dict = [NSMutableDictionary dictionary];
 	[dict setObject:[NSValue valueWithPointer:lf] forKey:@"friend"];
-	[dict setObject:[NSValue valueWithPointer:uri] forKey:@"uri"];
-	[dict setObject:[NSValue valueWithPointer:model] forKey:@"presence_model"];
-	[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneNotifyPresenceReceivedForUriOrTel
-	 object:self
-	 userInfo:dict];
+	linphone_friend_ref(lf);
+	[_notificationCoalescer postNotificationName:kLinphoneNotifyPresenceReceivedForUriOrTel
+										  object:self
+										userInfo:dict
+								   coalescingKey:[NSValue valueWithPointer:lf]
+										 release:^{
+										   linphone_friend_unref(lf);
+										 }];
 }
 
 static void linphone_iphone_notify_presence_received_for_uri_or_tel(LinphoneCore *lc, LinphoneFriend *lf,
@@ -1117,9 +1181,17 @@ token:(const char *)authentication_token {
 	[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneCallEncryptionChanged object:self userInfo:dict];
 }
 
+static void linphone_iphone_network_reachable(LinphoneCore *lc, bool_t reachable) {
+	[theLinphoneManager updateFileTransferNetwork];
+}
+
 void linphone_iphone_chatroom_state_changed(LinphoneCore *lc, LinphoneChatRoom *cr, LinphoneChatRoomState state) {
     if (state == LinphoneChatRoomStateCreated) {
-        [NSNotificationCenter.defaultCenter postNotificationName:kLinphoneMessageReceived object:nil];
+        [LinphoneManager.instance.notificationCoalescer postNotificationName:kLinphoneMessageReceived
+                                                                       object:nil
+                                                                     userInfo:nil
+                                                                coalescingKey:NSNull.null
+                                                                      release:nil];
     }
 }
 
@@ -1153,11 +1225,16 @@ void linphone_iphone_qr_code_found(LinphoneCore *lc, const char *result) {
 
 #pragma mark - Message composition start
 - (void)onMessageComposeReceived:(LinphoneCore *)core forRoom:(LinphoneChatRoom *)room {
-	[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneTextComposeEvent
-	 object:self
-	 userInfo:@{
-			@"room" : [NSValue valueWithPointer:room]
-				}];
+	linphone_chat_room_ref(room);
+	[_notificationCoalescer postNotificationName:kLinphoneTextComposeEvent
+										  object:self
+										userInfo:@{
+											@"room" : [NSValue valueWithPointer:room]
+										}
+								   coalescingKey:[NSValue valueWithPointer:room]
+										 release:^{
+										   linphone_chat_room_unref(room);
+										 }];
 }
 
 static void linphone_iphone_is_composing_received(LinphoneCore *lc, LinphoneChatRoom *room) {
@@ -1184,8 +1261,7 @@ static void linphone_iphone_is_composing_received(LinphoneCore *lc, LinphoneChat
 		return [number intValue];
 	} else {
 #pragma deploymate push "ignored-api-availability"
-		CTTelephonyNetworkInfo *info = [[CTTelephonyNetworkInfo alloc] init];
-		NSString *currentRadio = info.currentRadioAccessTechnology;
+		NSString *currentRadio = telephonyNetworkInfo.currentRadioAccessTechnology;
 		if ([currentRadio isEqualToString:CTRadioAccessTechnologyEdge]) {
 			return network_2g;
 		} else if ([currentRadio isEqualToString:CTRadioAccessTechnologyLTE]) {
@@ -1196,10 +1272,32 @@ static void linphone_iphone_is_composing_received(LinphoneCore *lc, LinphoneChat
 	}
 }
 
+- (void)radioAccessChanged:(NSNotification *)notif {
+	// posted on a CoreTelephony queue
+	dispatch_async(dispatch_get_main_queue(), ^{
+		[self updateFileTransferNetwork];
+	});
+}
+
+- (void)updateFileTransferNetwork {
+	// queued transfers wait for the network, and for a faster one than EDGE when nobody is looking at them
+	_fileTransferScheduler.paused = theLinphoneCore && !linphone_core_is_network_reachable(theLinphoneCore);
+	// the radio access technology is still reported while the data goes through WiFi
+	SCNetworkReachabilityFlags flags = 0;
+	BOOL cellular = defaultRouteReachability && SCNetworkReachabilityGetFlags(defaultRouteReachability, &flags) &&
+					(flags & kSCNetworkReachabilityFlagsIsWWAN);
+	_fileTransferScheduler.backgroundPaused = cellular && self.network == network_2g;
+}
+
 #pragma mark -
 
 // scheduling loop
 - (void)iterate {
+	// a background task is only needed to protect the iteration when we are not in foreground
+	if ([UIApplication sharedApplication].applicationState != UIApplicationStateBackground) {
+		linphone_core_iterate(theLinphoneCore);
+		return;
+	}
 	UIBackgroundTaskIdentifier coreIterateTaskId = 0;
 	coreIterateTaskId = [[UIApplication sharedApplication] beginBackgroundTaskWithExpirationHandler:^{
 			LOGW(@"Background task for core iteration launching expired.");
@@ -1210,10 +1308,42 @@ static void linphone_iphone_is_composing_received(LinphoneCore *lc, LinphoneChat
 		[[UIApplication sharedApplication] endBackgroundTask:coreIterateTaskId];
 }
 
+- (void)startCoreScheduler {
+	NSString *mode = [self lpConfigStringForKey:@"core_scheduler" inSection:@"app" withDefault:@"adaptive"];
+	__weak LinphoneManager *weakSelf = self;
+	_coreScheduler = [[CoreScheduler alloc]
+		initWithMode:[mode isEqualToString:@"timer"] ? CoreSchedulerModeTimer : CoreSchedulerModeAdaptive
+			   queue:dispatch_get_main_queue()
+			 iterate:^{
+			   [weakSelf iterate];
+			 }];
+	int idlePeriod = [self lpConfigIntForKey:@"core_scheduler_idle_period_ms" inSection:@"app" withDefault:200];
+	if (idlePeriod > 0)
+		_coreScheduler.idlePeriod = idlePeriod / 1000.;
+	_coreScheduler.activity = ^BOOL {
+	  if (!theLinphoneCore)
+		  return FALSE;
+	  // media streams and running file transfers need the fast period
+	  if (linphone_core_get_calls_nb(theLinphoneCore) > 0 || weakSelf.fileTransferScheduler.runningCount > 0)
+		  return TRUE;
+	  // as well as registrations waiting for their answer. Otherwise the core is idle, in foreground too: incoming
+	  // SIP traffic then waits at most one idle period, and the actions of the user wake the scheduler up.
+	  for (const MSList *proxies = linphone_core_get_proxy_config_list(theLinphoneCore); proxies;
+		   proxies = proxies->next) {
+		  if (linphone_proxy_config_get_state(proxies->data) == LinphoneRegistrationProgress)
+			  return TRUE;
+	  }
+	  return FALSE;
+	};
+	[_coreScheduler start];
+}
+
 /** Should be called once per linphone_core_new() */
 - (void)finishCoreConfiguration {
 	//Force keep alive to workaround push notif on chat message
 	linphone_core_enable_keep_alive(theLinphoneCore, true);
+	// incoming files are queued with the other transfers, see autoDownload:
+	linphone_core_set_max_size_for_auto_download_incoming_files(theLinphoneCore, -1);
 
 	// get default config from bundle
 	NSString *zrtpSecretsFileName = [LinphoneManager dataFile:@"zrtp_secrets"];
@@ -1435,6 +1565,7 @@ void popup_link_account_cb(LinphoneAccountCreator *creator, LinphoneAccountCreat
 	linphone_core_cbs_set_notify_received(cbs, linphone_iphone_notify_received);
 	linphone_core_cbs_set_call_encryption_changed(cbs, linphone_iphone_call_encryption_changed);
 	linphone_core_cbs_set_chat_room_state_changed(cbs, linphone_iphone_chatroom_state_changed);
+	linphone_core_cbs_set_network_reachable(cbs, linphone_iphone_network_reachable);
 	linphone_core_cbs_set_version_update_check_result_received(cbs, linphone_iphone_version_update_check_result_received);
 	linphone_core_cbs_set_qrcode_found(cbs, linphone_iphone_qr_code_found);
 	linphone_core_cbs_set_user_data(cbs, (__bridge void *)(self));
@@ -1486,21 +1617,30 @@ void popup_link_account_cb(LinphoneAccountCreator *creator, LinphoneAccountCreat
 	 * grab, if any */
 	[self iterate];
 	// start scheduler
-	mIterateTimer =
-		[NSTimer scheduledTimerWithTimeInterval:0.02 target:self selector:@selector(iterate) userInfo:nil repeats:YES];
+	[self startCoreScheduler];
+	_fileTransferScheduler.maxConcurrentTransfers =
+		[self lpConfigIntForKey:@"file_transfer_max_concurrent" inSection:@"app" withDefault:3];
+	[self updateFileTransferNetwork];
 }
 
 - (void)destroyLinphoneCore {
-	[mIterateTimer invalidate];
+	[_coreScheduler stop];
+	// pending metadata must be written before the messages go away
+	[MessageAppDataCache.sharedCache clear];
+	[MessageLayoutCache.sharedCache clear];
+	_coreScheduler = nil;
 	// just in case
 	[self removeCTCallCenterCb];
 
 	if (theLinphoneCore != nil) { // just in case application terminate before linphone core initialization
 
-		for (FileTransferDelegate *ftd in _fileTransferDelegates) {
+		for (FileTransferDelegate *ftd in _fileTransferRegistry.allDelegates) {
 			[ftd stopAndDestroy];
 		}
-		[_fileTransferDelegates removeAllObjects];
+		[_fileTransferRegistry removeAllDelegates];
+		[_fileTransferScheduler removeAllTransfers];
+		[_fastAddressBook.subscriptionCoalescer cancel];
+		[_notificationCoalescer cancel];
 
 		linphone_core_destroy(theLinphoneCore);
 		LOGI(@"Destroy linphonecore %p", theLinphoneCore);
@@ -1601,6 +1741,9 @@ static int comp_call_state_paused(const LinphoneCall *call, const void *param) {
 	if ([callId isEqualToString:@""])
 		return;
 
+	// the push announces incoming SIP traffic, do not wait for the idle period to process it
+	[_coreScheduler wakeUp];
+
 	if ([loc_key isEqualToString:@"IM_MSG"]) {
 		[[UIApplication sharedApplication] endBackgroundTask:pushBgTaskMsg];
 		pushBgTaskMsg = 0;
@@ -1769,6 +1912,7 @@ static int comp_call_state_paused(const LinphoneCall *call, const void *param) {
 
 - (void)becomeActive {
 	linphone_core_enter_foreground(LC);
+	[_coreScheduler wakeUp];
 
 	[self checkNewVersion];
 
@@ -1933,6 +2077,7 @@ static int comp_call_state_paused(const LinphoneCall *call, const void *param) {
 - (void)send:(NSString *)replyText toChatRoom:(LinphoneChatRoom *)room {
 	LinphoneChatMessage *msg = linphone_chat_room_create_message(room, replyText.UTF8String);
 	linphone_chat_message_send(msg);
+	[_coreScheduler wakeUp];
 
 	[ChatConversationView markAsRead:room];
 }
@@ -1979,6 +2124,7 @@ static int comp_call_state_paused(const LinphoneCall *call, const void *param) {
 
 	// For OutgoingCall, show CallOutgoingView
 	[CallManager.instance startCallWithAddr:iaddr isSas:FALSE];
+	[_coreScheduler wakeUp];
 }
 
 #pragma mark - Property Functions
@@ -2183,36 +2329,17 @@ static int comp_call_state_paused(const LinphoneCall *call, const void *param) {
 }
 
 + (id)getMessageAppDataForKey:(NSString *)key inMessage:(LinphoneChatMessage *)msg {
+	return [MessageAppDataCache.sharedCache valueForKey:key inMessage:msg];
+}
 
-	if (msg == nil)
-		return nil;
-
-	id value = nil;
-	const char *appData = linphone_chat_message_get_appdata(msg);
-	if (appData) {
-		NSDictionary *appDataDict =
-			[NSJSONSerialization JSONObjectWithData:[NSData dataWithBytes:appData length:strlen(appData)]
-			 options:0
-			 error:nil];
-		value = [appDataDict objectForKey:key];
-	}
-	return value;
++ (NSDictionary *)getMessageAppData:(LinphoneChatMessage *)msg {
+	return [MessageAppDataCache.sharedCache appDataForMessage:msg];
 }
 
 + (void)setValueInMessageAppData:(id)value forKey:(NSString *)key inMessage:(LinphoneChatMessage *)msg {
-        NSMutableDictionary *appDataDict = [NSMutableDictionary dictionary];
-        const char *appData = linphone_chat_message_get_appdata(msg);
-        if (appData) {
-		appDataDict = [NSJSONSerialization JSONObjectWithData:[NSData dataWithBytes:appData length:strlen(appData)]
-			       options:NSJSONReadingMutableContainers
-			       error:nil];
-        }
-
-        [appDataDict setValue:value forKey:key];
-
-        NSData *data = [NSJSONSerialization dataWithJSONObject:appDataDict options:0 error:nil];
-        NSString *appdataJSON = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-        linphone_chat_message_set_appdata(msg, [appdataJSON UTF8String]);
+	[MessageAppDataCache.sharedCache setValue:value forKey:key inMessage:msg];
+	// the size of the bubble depends on the attached media
+	[MessageLayoutCache.sharedCache invalidateMessage:msg];
 }
 
 #pragma mark - LPConfig Functions
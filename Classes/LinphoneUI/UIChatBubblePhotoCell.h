@@ -25,7 +25,7 @@
 #import "ChatConversationTableView.h"
 #import "UIChatBubbleTextCell.h"
 
-@interface UIChatBubblePhotoCell : UIChatBubbleTextCell
+@interface UIChatBubblePhotoCell : UIChatBubbleTextCell <FileTransferProgressDelegate>
 
 @property(nonatomic, strong) IBOutlet UILoadingImageView *messageImageView;
 @property(nonatomic, strong) IBOutlet UIButton *downloadButton;
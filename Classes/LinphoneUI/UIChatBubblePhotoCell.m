@@ -79,19 +79,10 @@
 	[self disconnectFromFileDelegate];
 
 	if (amessage) {
-		const LinphoneContent *c = linphone_chat_message_get_file_transfer_information(amessage);
-		if (c) {
-			const char *name = linphone_content_get_name(c);
-			for (FileTransferDelegate *aftd in [LinphoneManager.instance fileTransferDelegates]) {
-				if (linphone_chat_message_get_file_transfer_information(aftd.message) &&
-					(linphone_chat_message_is_outgoing(aftd.message) == linphone_chat_message_is_outgoing(amessage)) &&
-					strcmp(name, linphone_content_get_name(
-									 linphone_chat_message_get_file_transfer_information(aftd.message))) == 0) {
-					LOGI(@"Chat message [%p] with file transfer delegate [%p], connecting to it!", amessage, aftd);
-					[self connectToFileDelegate:aftd];
-					break;
-				}
-			}
+		FileTransferDelegate *aftd = [LinphoneManager.instance.fileTransferRegistry delegateForFileOfMessage:amessage];
+		if (aftd) {
+			LOGI(@"Chat message [%p] with file transfer delegate [%p], connecting to it!", amessage, aftd);
+			[self connectToFileDelegate:aftd];
 		}
 	}
 
@@ -157,9 +148,10 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
 	const char *url = linphone_chat_message_get_external_body_url(self.message);
 	BOOL is_external =
 		(url && (strstr(url, "http") == url)) || linphone_chat_message_get_file_transfer_information(self.message);
-	NSString *localImage = [LinphoneManager getMessageAppDataForKey:@"localimage" inMessage:self.message];
-    NSString *localVideo = [LinphoneManager getMessageAppDataForKey:@"localvideo" inMessage:self.message];
-    NSString *localFile = [LinphoneManager getMessageAppDataForKey:@"localfile" inMessage:self.message];
+	NSDictionary *appData = [LinphoneManager getMessageAppData:self.message];
+	NSString *localImage = [appData objectForKey:@"localimage"];
+	NSString *localVideo = [appData objectForKey:@"localvideo"];
+	NSString *localFile = [appData objectForKey:@"localfile"];
 	assert(is_external || localImage || localVideo || localFile);
     
     LinphoneContent *fileContent = linphone_chat_message_get_file_transfer_information(self.message);
@@ -364,6 +356,7 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
 	}
 
 	_ftd = aftd;
+	_ftd.progressDelegate = self;
 	_fileTransferProgress.progress = 0;
 	[NSNotificationCenter.defaultCenter removeObserver:self];
 	[NSNotificationCenter.defaultCenter addObserver:self
@@ -379,36 +372,29 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
 - (void)disconnectFromFileDelegate {
 	[NSNotificationCenter.defaultCenter removeObserver:self name:kLinphoneFileTransferSendUpdate object:_ftd];
     [NSNotificationCenter.defaultCenter removeObserver:self name:kLinphoneFileTransferRecvUpdate object:_ftd];
+	if (_ftd.progressDelegate == self)
+		_ftd.progressDelegate = nil;
 	_ftd = nil;
 }
 
+- (void)fileTransfer:(FileTransferDelegate *)ftd didUpdateProgress:(float)progress {
+	if (ftd != _ftd)
+		return;
+	// When uploading a file, the message is first uploaded to the server and then sent to the other participant:
+	// the progress of the second step must not be displayed
+	_fileTransferProgress.progress = MAX(_fileTransferProgress.progress, progress);
+	_fileTransferProgress.hidden = _cancelButton.hidden = (_fileTransferProgress.progress == 1.f);
+}
+
+// progress goes through fileTransfer:didUpdateProgress:, these are only posted once a transfer is over
 - (void)onFileTransferSendUpdate:(NSNotification *)notif {
-	LinphoneChatMessageState state = [[[notif userInfo] objectForKey:@"state"] intValue];
-
-	if (state == LinphoneChatMessageStateInProgress || state == LinphoneChatMessageStateFileTransferInProgress) {
-		float progress = [[[notif userInfo] objectForKey:@"progress"] floatValue];
-		// When uploading a file, the self.message file is first uploaded to the server,
-		// so we are in progress state. Then state goes to filetransfertdone. Then,
-		// the exact same self.message is sent to the other participant and we come
-		// back to in progress again. This second time is NOT an upload, so we must
-		// not update progress!
-		_fileTransferProgress.progress = MAX(_fileTransferProgress.progress, progress);
-		_fileTransferProgress.hidden = _cancelButton.hidden = (_fileTransferProgress.progress == 1.f);
-	} else {
-		ChatConversationView *view = VIEW(ChatConversationView);
-		[view.tableController updateEventEntry:self.event];
-	}
+	ChatConversationView *view = VIEW(ChatConversationView);
+	[view.tableController updateEventEntry:self.event];
 }
+
 - (void)onFileTransferRecvUpdate:(NSNotification *)notif {
-	LinphoneChatMessageState state = [[[notif userInfo] objectForKey:@"state"] intValue];
-	if (state == LinphoneChatMessageStateInProgress || state == LinphoneChatMessageStateFileTransferInProgress) {
-		float progress = [[[notif userInfo] objectForKey:@"progress"] floatValue];
-		_fileTransferProgress.progress = MAX(_fileTransferProgress.progress, progress);
-		_fileTransferProgress.hidden = _cancelButton.hidden = (_fileTransferProgress.progress == 1.f);
-	} else {
-		ChatConversationView *view = VIEW(ChatConversationView);
-		[view.tableController updateEventEntry:self.event];
-	}
+	ChatConversationView *view = VIEW(ChatConversationView);
+	[view.tableController updateEventEntry:self.event];
 }
 
 - (void)layoutSubviews {
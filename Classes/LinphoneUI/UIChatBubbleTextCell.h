@@ -50,6 +50,8 @@
 + (CGSize)ViewHeightForMessageText:(LinphoneChatMessage *)chat withWidth:(int)width textForImdn:(NSString *)imdnText;
 + (CGSize)getMediaMessageSizefromOriginalSize:(CGSize)originalSize withWidth:(int)width;
 + (UIImage *)getImageFromVideoUrl:(NSURL *)url;
+/* read the dimensions of the medias attached to these events in background, ahead of their display */
++ (void)prefetchMediaSizesForEvents:(NSArray<NSValue *> *)events;
 
 - (void)setEvent:(LinphoneEventLog *)event;
 - (void)setChatMessage:(LinphoneChatMessage *)message;
@@ -23,6 +23,7 @@
 
 #import <AssetsLibrary/ALAsset.h>
 #import <AssetsLibrary/ALAssetRepresentation.h>
+#import <ImageIO/ImageIO.h>
 
 @implementation UIChatBubbleTextCell
 
@@ -157,9 +158,17 @@
         _avatarImage.hidden = TRUE;
         
     } else {
-        [_avatarImage setImage:[FastAddressBook imageForAddress:linphone_chat_message_get_from_address(_message)]
-                      bordered:NO
-             withRoundedRadius:YES];
+        __weak UIChatBubbleTextCell *weakSelf = self;
+        LinphoneChatMessage *message = _message;
+        UIImage *avatar = [FastAddressBook thumbnailForAddress:linphone_chat_message_get_from_address(_message)
+                                                          side:_avatarImage.bounds.size.width
+                                                    completion:^(UIImage *thumbnail) {
+                                                      UIChatBubbleTextCell *cell = weakSelf;
+                                                      // the cell may have been reused meanwhile
+                                                      if (cell && cell.message == message)
+                                                          [cell.avatarImage setImage:thumbnail bordered:NO withRoundedRadius:YES];
+                                                    }];
+        [_avatarImage setImage:avatar bordered:NO withRoundedRadius:YES];
         _contactDateLabel.text = [self.class ContactDateForChat:_message];
         _contactDateLabel.textAlignment = NSTextAlignmentLeft;
         _avatarImage.hidden = !_isFirst;
@@ -274,10 +283,11 @@
 		return;
 
 	if (linphone_chat_message_get_file_transfer_information(_message) != NULL) {
-		NSString *localImage = [LinphoneManager getMessageAppDataForKey:@"localimage" inMessage:_message];
-		NSNumber *uploadQuality =[LinphoneManager getMessageAppDataForKey:@"uploadQuality" inMessage:_message];
-        NSString *localVideo = [LinphoneManager getMessageAppDataForKey:@"localvideo" inMessage:_message];
-        NSString *localFile = [LinphoneManager getMessageAppDataForKey:@"localfile" inMessage:_message];
+		NSDictionary *appData = [LinphoneManager getMessageAppData:_message];
+		NSString *localImage = [appData objectForKey:@"localimage"];
+		NSNumber *uploadQuality = [appData objectForKey:@"uploadQuality"];
+		NSString *localVideo = [appData objectForKey:@"localvideo"];
+		NSString *localFile = [appData objectForKey:@"localfile"];
 
 		[self onDelete];
         if(localImage){
@@ -326,7 +336,7 @@
                 AVURLAsset *urlAsset = (AVURLAsset *)asset;
                     
                 NSURL *url = urlAsset.URL;
-                NSData *data = [NSData dataWithContentsOfURL:url];
+                NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:nil];
                 dispatch_async(dispatch_get_main_queue(),
                                 ^(void) {
                                     [_chatRoomDelegate startFileUpload:data assetId:localVideo];
@@ -334,7 +344,7 @@
             }];
 
         } else if (localFile) {
-            NSData *data = [NSData dataWithContentsOfURL:[VIEW(ChatConversationView) getICloudFileUrl:localFile]];
+            NSData *data = [NSData dataWithContentsOfURL:[VIEW(ChatConversationView) getICloudFileUrl:localFile] options:NSDataReadingMappedIfSafe error:nil];
             [_chatRoomDelegate startFileUpload:data withName:localFile];
         }
 	} else {
@@ -399,8 +409,62 @@ static const CGFloat CELL_MESSAGE_X_MARGIN = 68 + 10.0f;
 static const CGFloat CELL_MESSAGE_Y_MARGIN = 44;
 static const CGFloat CELL_IMAGE_X_MARGIN = 100;
 
+// sizes kept in MessageLayoutCache for each message
+static const int CELL_SIZE_BUBBLE = 0;
+static const int CELL_SIZE_VIEW = 1;
+// media sizes depend on the orientation, see getMediaMessageSizefromOriginalSize
+static const int CELL_SIZE_LANDSCAPE = 0x10;
+
++ (int)cachedSizeKind:(int)kind {
+	if (UIInterfaceOrientationIsLandscape([[UIApplication sharedApplication] statusBarOrientation]))
+		kind |= CELL_SIZE_LANDSCAPE;
+	return kind;
+}
+
 + (CGSize)ViewHeightForMessage:(LinphoneChatMessage *)chat withWidth:(int)width {
-    return [self ViewHeightForMessageText:chat withWidth:width textForImdn:nil];
+	int kind = [self cachedSizeKind:CELL_SIZE_BUBBLE];
+	NSValue *cached = [MessageLayoutCache.sharedCache sizeForMessage:chat kind:kind width:width];
+	if (cached)
+		return cached.CGSizeValue;
+
+	CGSize size = [self ViewHeightForMessageText:chat withWidth:width textForImdn:nil];
+	if ([self isLayoutFinal:chat])
+		[MessageLayoutCache.sharedCache setSize:size forMessage:chat kind:kind width:width];
+	return size;
+}
+
+static NSString *fileMediaKey(NSString *localFile) {
+	return [@"file:" stringByAppendingString:localFile];
+}
+
+static BOOL isImageFile(NSString *localFile) {
+	return [localFile hasSuffix:@"JPG"] || [localFile hasSuffix:@"PNG"] || [localFile hasSuffix:@"jpg"] || [localFile hasSuffix:@"png"];
+}
+
+// placeholders written in the appdata while a media is being saved or sent
+static BOOL isPlaceholderMediaKey(NSString *key) {
+	return [key isEqualToString:@"saving..."] || [key isEqualToString:@"ending..."];
+}
+
+// A bubble laid out while its media is still loading, or before the media dimensions are known, only has a
+// temporary size: it must be computed again once the media is there instead of being kept in the cache.
++ (BOOL)isLayoutFinal:(LinphoneChatMessage *)chat {
+	if (!linphone_chat_message_get_file_transfer_information(chat))
+		return YES;
+	NSDictionary *appData = [LinphoneManager getMessageAppData:chat];
+	NSString *localFile = [appData objectForKey:@"localfile"];
+	NSString *key = localFile ? localFile : ([appData objectForKey:@"localimage"] ?: [appData objectForKey:@"localvideo"]);
+	if (!key || isPlaceholderMediaKey(key))
+		return NO;
+	if (localFile) {
+		// other files are shown with a fixed size
+		const char *type = linphone_content_get_type(linphone_chat_message_get_file_transfer_information(chat));
+		BOOL isVideo = type && strcmp(type, "video") == 0;
+		if (!isVideo && !isImageFile(localFile))
+			return YES;
+		key = fileMediaKey(localFile);
+	}
+	return [MessageLayoutCache.sharedCache mediaSizeForKey:key] != nil;
 }
 
 + (CGSize)ViewHeightForMessageText:(LinphoneChatMessage *)chat withWidth:(int)width textForImdn:(NSString *)imdnText{
@@ -431,9 +495,10 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
                                     size:CGSizeMake(width - CELL_MESSAGE_X_MARGIN - 4, CGFLOAT_MAX)
                                     font:messageFont];
     } else {
-        NSString *localImage = [LinphoneManager getMessageAppDataForKey:@"localimage" inMessage:chat];
-        NSString *localFile = [LinphoneManager getMessageAppDataForKey:@"localfile" inMessage:chat];
-        NSString *localVideo = [LinphoneManager getMessageAppDataForKey:@"localvideo" inMessage:chat];
+        NSDictionary *appData = [LinphoneManager getMessageAppData:chat];
+        NSString *localImage = [appData objectForKey:@"localimage"];
+        NSString *localFile = [appData objectForKey:@"localfile"];
+        NSString *localVideo = [appData objectForKey:@"localvideo"];
         
         CGSize textSize = CGSizeMake(0, 0);
         if (![messageText isEqualToString:@"🗻"]) {
@@ -444,17 +509,11 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
         }
         
         if(localFile) {
-            UIImage *image = nil;
             NSString *type = [NSString stringWithUTF8String:linphone_content_get_type(fileContent)];
-            if ([type isEqualToString:@"video"]) {
-                image = [self getImageFromVideoUrl:[VIEW(ChatConversationView) getICloudFileUrl:localFile]];
-            } else if ([localFile hasSuffix:@"JPG"] || [localFile hasSuffix:@"PNG"] || [localFile hasSuffix:@"jpg"] || [localFile hasSuffix:@"png"]) {
-                NSData *data = [NSData dataWithContentsOfURL:[VIEW(ChatConversationView) getICloudFileUrl:localFile]];
-                image = [[UIImage alloc] initWithData:data];
-            }
+            CGSize imageSize = [self mediaSizeForFile:localFile isVideo:[type isEqualToString:@"video"] url:nil];
 
-            if (image) {
-                size = [self getMediaMessageSizefromOriginalSize:image.size withWidth:width];
+            if (!CGSizeEqualToSize(imageSize, CGSizeZero)) {
+                size = [self getMediaMessageSizefromOriginalSize:imageSize withWidth:width];
                 // add size for message text
                 size.height += textSize.height;
                 size.width = MAX(textSize.width, size.width);
@@ -467,16 +526,10 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
                 //We are loading the image
                 return CGSizeMake(CELL_MIN_WIDTH + CELL_MESSAGE_X_MARGIN, CELL_MIN_HEIGHT + CELL_MESSAGE_Y_MARGIN + textSize.height + 20);
             }
-            PHFetchResult<PHAsset *> *assets;
-            if(localImage)
-                assets = [LinphoneManager getPHAssets:localImage];
-            else
-                assets = [PHAsset fetchAssetsWithLocalIdentifiers:[NSArray arrayWithObject:localVideo] options:nil];
-            if (![assets firstObject]) {
+            CGSize originalImageSize = [self mediaSizeForAsset:localImage video:localVideo];
+            if (CGSizeEqualToSize(originalImageSize, CGSizeZero)) {
                 return CGSizeMake(CELL_MIN_WIDTH, CELL_MIN_WIDTH + CELL_MESSAGE_Y_MARGIN + textSize.height);
             } else {
-                PHAsset *asset = [assets firstObject];
-                CGSize originalImageSize = CGSizeMake([asset pixelWidth], [asset pixelHeight]);
                 size = [self getMediaMessageSizefromOriginalSize:originalImageSize withWidth:width];
                     
                 // add size for message text
@@ -495,6 +548,11 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
 	static UIFont *dateFont = nil;
 	static CGSize dateViewSize;
 
+	int kind = [self cachedSizeKind:CELL_SIZE_VIEW];
+	NSValue *cached = [MessageLayoutCache.sharedCache sizeForMessage:chat kind:kind width:width];
+	if (cached)
+		return cached.CGSizeValue;
+
 	if (!dateFont) {
 		UIChatBubbleTextCell *cell =
 			[[UIChatBubbleTextCell alloc] initWithIdentifier:NSStringFromClass(UIChatBubbleTextCell.class)];
@@ -508,9 +566,120 @@ static const CGFloat CELL_IMAGE_X_MARGIN = 100;
 	messageSize.width = MAX(MAX(messageSize.width, MIN(dateSize.width + CELL_MESSAGE_X_MARGIN, width)), CELL_MIN_WIDTH);
     messageSize.width = MAX(MAX(messageSize.width, MIN(CELL_MESSAGE_X_MARGIN, width)), CELL_MIN_WIDTH);
 
+	if ([self isLayoutFinal:chat])
+		[MessageLayoutCache.sharedCache setSize:messageSize forMessage:chat kind:kind width:width];
 	return messageSize;
 }
 
+#pragma mark - Media size computing
+
+// Dimensions of an image file, read from its header without decoding it.
++ (CGSize)imageSizeAtUrl:(NSURL *)url {
+	CGImageSourceRef source = CGImageSourceCreateWithURL((__bridge CFURLRef)url, NULL);
+	if (!source)
+		return CGSizeZero;
+	NSDictionary *properties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+	CFRelease(source);
+	CGSize size = CGSizeMake([properties[(NSString *)kCGImagePropertyPixelWidth] floatValue],
+							 [properties[(NSString *)kCGImagePropertyPixelHeight] floatValue]);
+	// orientations 5 to 8 are rotated by 90 degrees, as UIImage does
+	if ([properties[(NSString *)kCGImagePropertyOrientation] intValue] >= 5)
+		size = CGSizeMake(size.height, size.width);
+	return size;
+}
+
+// Dimensions of the first frame of a video, as returned by getImageFromVideoUrl.
++ (CGSize)videoSizeAtUrl:(NSURL *)url {
+	AVURLAsset *asset = [AVURLAsset URLAssetWithURL:url options:nil];
+	AVAssetTrack *track = [[asset tracksWithMediaType:AVMediaTypeVideo] firstObject];
+	if (!track)
+		return CGSizeZero;
+	CGSize size = CGSizeApplyAffineTransform(track.naturalSize, track.preferredTransform);
+	return CGSizeMake(fabs(size.width), fabs(size.height));
+}
+
++ (CGSize)mediaSizeForFile:(NSString *)localFile isVideo:(BOOL)isVideo url:(NSURL *)url {
+	if (isPlaceholderMediaKey(localFile))
+		return CGSizeZero;
+	NSString *key = fileMediaKey(localFile);
+	NSValue *cached = [MessageLayoutCache.sharedCache mediaSizeForKey:key];
+	if (cached)
+		return cached.CGSizeValue;
+
+	if (!url)
+		url = [VIEW(ChatConversationView) getICloudFileUrl:localFile];
+	CGSize size = CGSizeZero;
+	if (isVideo) {
+		size = [self videoSizeAtUrl:url];
+	} else if (isImageFile(localFile)) {
+		size = [self imageSizeAtUrl:url];
+	}
+	[MessageLayoutCache.sharedCache setMediaSize:size forKey:key];
+	return size;
+}
+
++ (CGSize)mediaSizeForAsset:(NSString *)localImage video:(NSString *)localVideo {
+	NSString *key = localImage ?: localVideo;
+	if (isPlaceholderMediaKey(key))
+		return CGSizeZero;
+	NSValue *cached = [MessageLayoutCache.sharedCache mediaSizeForKey:key];
+	if (cached)
+		return cached.CGSizeValue;
+
+	PHFetchResult<PHAsset *> *assets;
+	if (localImage)
+		assets = [LinphoneManager getPHAssets:localImage];
+	else
+		assets = [PHAsset fetchAssetsWithLocalIdentifiers:[NSArray arrayWithObject:localVideo] options:nil];
+	PHAsset *asset = [assets firstObject];
+	CGSize size = asset ? CGSizeMake([asset pixelWidth], [asset pixelHeight]) : CGSizeZero;
+	[MessageLayoutCache.sharedCache setMediaSize:size forKey:key];
+	return size;
+}
+
++ (void)prefetchMediaSizesForEvents:(NSArray<NSValue *> *)events {
+	// the messages must be read here, on the main thread, only the file and photo library accesses are deferred
+	NSMutableArray<dispatch_block_t> *jobs = [NSMutableArray array];
+	for (NSValue *value in events) {
+		LinphoneEventLog *event = value.pointerValue;
+		if (linphone_event_log_get_type(event) != LinphoneEventLogTypeConferenceChatMessage)
+			continue;
+		LinphoneChatMessage *chat = linphone_event_log_get_chat_message(event);
+		LinphoneContent *fileContent = linphone_chat_message_get_file_transfer_information(chat);
+		if (!fileContent)
+			continue;
+
+		NSDictionary *appData = [LinphoneManager getMessageAppData:chat];
+		NSString *localImage = [appData objectForKey:@"localimage"];
+		NSString *localFile = [appData objectForKey:@"localfile"];
+		NSString *localVideo = [appData objectForKey:@"localvideo"];
+		if (localFile) {
+			if ([MessageLayoutCache.sharedCache mediaSizeForKey:fileMediaKey(localFile)])
+				continue;
+			const char *type = linphone_content_get_type(fileContent);
+			BOOL isVideo = type && strcmp(type, "video") == 0;
+			NSURL *url = [VIEW(ChatConversationView) getICloudFileUrl:localFile];
+			[jobs addObject:^{
+				[self mediaSizeForFile:localFile isVideo:isVideo url:url];
+			}];
+		} else if (localImage || localVideo) {
+			if ([MessageLayoutCache.sharedCache mediaSizeForKey:localImage ?: localVideo])
+				continue;
+			[jobs addObject:^{
+				[self mediaSizeForAsset:localImage video:localVideo];
+			}];
+		}
+	}
+	if (jobs.count == 0)
+		return;
+
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		for (dispatch_block_t job in jobs) {
+			job();
+		}
+	});
+}
+
 + (UIImage *)getImageFromVideoUrl:(NSURL *)url {
     AVURLAsset* asset = [AVURLAsset URLAssetWithURL:url options:nil];
     AVAssetImageGenerator* generator = [AVAssetImageGenerator assetImageGeneratorWithAsset:asset];
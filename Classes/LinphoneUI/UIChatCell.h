@@ -25,6 +25,28 @@
 
 #include "linphone/linphonecore.h"
 
+@class Contact;
+
+/*
+ * What a chat list row shows of its chat room, computed once when the room changes rather than each time a cell is
+ * configured. The unread count is not part of it, it is read when the badge is updated.
+ * Must be created from the main thread.
+ */
+@interface UIChatCellModel : NSObject
+
+- (instancetype)initWithChatRoom:(LinphoneChatRoom *)chatRoom;
+
+@property(readonly) NSString *title;
+// the avatar of group chat rooms and of the local user, otherwise nil and the avatar of contact is shown
+@property(readonly) UIImage *fixedAvatar;
+@property(readonly) Contact *contact;
+@property(readonly) UIImage *securityImage;
+@property(readonly) NSString *timeText;
+// "<sender> : <message>", nil when the chat room has no message
+@property(readonly) NSString *lastMessagePreview;
+
+@end
+
 @interface UIChatCell : UITableViewCell {
 	LinphoneChatRoom *chatRoom;
 }
@@ -42,5 +64,5 @@
 
 - (IBAction)onDeleteClick:(id)event;
 - (void)updateUnreadBadge;
-- (void)setChatRoom:(LinphoneChatRoom *)achat;
+- (void)setChatRoom:(LinphoneChatRoom *)achat model:(UIChatCellModel *)model;
 @end
@@ -22,7 +22,50 @@
 #import "LinphoneManager.h"
 #import "Utils.h"
 
-@implementation UIChatCell
+@implementation UIChatCellModel
+
+- (instancetype)initWithChatRoom:(LinphoneChatRoom *)chatRoom {
+	if ((self = [super init])) {
+		LinphoneChatRoomCapabilitiesMask capabilities = linphone_chat_room_get_capabilities(chatRoom);
+		if (capabilities & LinphoneChatRoomCapabilitiesOneToOne) {
+			bctbx_list_t *participants = linphone_chat_room_get_participants(chatRoom);
+			LinphoneParticipant *firstParticipant = participants ? (LinphoneParticipant *)participants->data : NULL;
+			const LinphoneAddress *addr = firstParticipant ? linphone_participant_get_address(firstParticipant)
+														   : linphone_chat_room_get_peer_address(chatRoom);
+			if (addr) {
+				_contact = [FastAddressBook getContactWithAddress:addr];
+				_title = _contact ? [FastAddressBook displayNameForContact:_contact]
+								  : [FastAddressBook displayNameForAddress:addr];
+				if ([LinphoneManager isMyself:addr] && [LinphoneUtils hasSelfAvatar])
+					_fixedAvatar = [LinphoneUtils selfAvatar];
+			} else {
+				_title = [NSString stringWithUTF8String:LINPHONE_DUMMY_SUBJECT];
+			}
+		} else {
+			const char *subject = linphone_chat_room_get_subject(chatRoom);
+			_title = [NSString stringWithUTF8String:subject ?: LINPHONE_DUMMY_SUBJECT];
+			_fixedAvatar = [UIImage imageNamed:@"chat_group_avatar.png"];
+		}
+		_securityImage = [FastAddressBook imageForSecurityLevel:linphone_chat_room_get_security_level(chatRoom)];
+		_timeText = [LinphoneUtils timeToString:linphone_chat_room_get_last_update_time(chatRoom)
+									 withFormat:LinphoneDateChatList];
+
+		LinphoneChatMessage *last_msg = linphone_chat_room_get_last_message_in_history(chatRoom);
+		if (last_msg) {
+			_lastMessagePreview =
+				[[FastAddressBook displayNameForAddress:linphone_chat_message_get_from_address(last_msg)]
+					stringByAppendingFormat:@" : %@", [UIChatBubbleTextCell TextMessageForChat:last_msg]];
+			linphone_chat_message_unref(last_msg);
+		}
+	}
+	return self;
+}
+
+@end
+
+@implementation UIChatCell {
+	UIChatCellModel *model;
+}
 
 #pragma mark - Lifecycle Functions
 
@@ -43,8 +86,9 @@
 
 #pragma mark - Property Funcitons
 
-- (void)setChatRoom:(LinphoneChatRoom *)achat {
+- (void)setChatRoom:(LinphoneChatRoom *)achat model:(UIChatCellModel *)amodel {
 	chatRoom = achat;
+	model = amodel;
 	[self update];
 }
 
@@ -60,93 +104,37 @@
 }
 
 - (void)update {
-	if (chatRoom == nil) {
+	if (chatRoom == nil || model == nil) {
 		LOGW(@"Cannot update chat cell: null chat");
 		return;
 	}
 
-	LinphoneChatRoomCapabilitiesMask capabilities = linphone_chat_room_get_capabilities(chatRoom);
-	if (capabilities & LinphoneChatRoomCapabilitiesOneToOne) {
-		bctbx_list_t *participants = linphone_chat_room_get_participants(chatRoom);
-		LinphoneParticipant *firstParticipant = participants ? (LinphoneParticipant *)participants->data : NULL;
-		const LinphoneAddress *addr = firstParticipant ? linphone_participant_get_address(firstParticipant) : linphone_chat_room_get_peer_address(chatRoom);
-		if (addr) {
-			[ContactDisplay setDisplayNameLabel:_addressLabel forAddress:addr];
-			[_avatarImage setImage:[FastAddressBook imageForAddress:addr] bordered:NO withRoundedRadius:YES];
-		} else {
-			_addressLabel.text = [NSString stringWithUTF8String:LINPHONE_DUMMY_SUBJECT];
-		}
+	_addressLabel.text = model.title;
+	if (model.fixedAvatar) {
+		[_avatarImage setImage:model.fixedAvatar bordered:NO withRoundedRadius:YES];
 	} else {
-		const char *subject = linphone_chat_room_get_subject(chatRoom);
-		_addressLabel.text = [NSString stringWithUTF8String:subject ?: LINPHONE_DUMMY_SUBJECT];
-		[_avatarImage setImage:[UIImage imageNamed:@"chat_group_avatar.png"] bordered:NO withRoundedRadius:YES];
+		__weak UIChatCell *weakSelf = self;
+		LinphoneChatRoom *room = chatRoom;
+		UIImage *avatar = [FastAddressBook thumbnailForContact:model.contact
+														  side:_avatarImage.bounds.size.width
+													completion:^(UIImage *thumbnail) {
+													  UIChatCell *cell = weakSelf;
+													  // the cell may have been reused meanwhile
+													  if (cell && cell->chatRoom == room)
+														  [cell.avatarImage setImage:thumbnail bordered:NO withRoundedRadius:YES];
+													}];
+		[_avatarImage setImage:avatar bordered:NO withRoundedRadius:YES];
 	}
-    // TODO update security image when security level changed
-    [_securityImage setImage:[FastAddressBook imageForSecurityLevel:linphone_chat_room_get_security_level(chatRoom)]];
-
-	_chatLatestTimeLabel.text = [LinphoneUtils timeToString:linphone_chat_room_get_last_update_time(chatRoom) withFormat:LinphoneDateChatList];
-
-	LinphoneChatMessage *last_msg = linphone_chat_room_get_last_message_in_history(chatRoom);
-	if (last_msg) {
-        BOOL imdnInSnap = FALSE;
-        if (imdnInSnap) {
-            BOOL outgoing = linphone_chat_message_is_outgoing(last_msg);
-            NSString *text = [UIChatBubbleTextCell TextMessageForChat:last_msg];
-            if (outgoing) {
-                // shorten long messages
-                /*if ([text length] > 50)
-                    text = [[text substringToIndex:50] stringByAppendingString:@"[...]"];*/
-                _chatContentLabel.attributedText = nil;
-                _chatContentLabel.text = text;
-            } else {
-                NSString *name = [FastAddressBook displayNameForAddress:linphone_chat_message_get_from_address(last_msg)];
-                if ([name length] > 25) {
-                    name = [[name substringToIndex:25] stringByAppendingString:@"[...]"];
-                }
-                CGFloat fontSize = _chatContentLabel.font.pointSize;
-                UIFont *boldFont = [UIFont boldSystemFontOfSize:fontSize];
-                NSMutableAttributedString *boldText = [[NSMutableAttributedString alloc] initWithString:name attributes:@{ NSFontAttributeName : boldFont }];
-                text = [@" : " stringByAppendingString:text];
-                //NSString *fullText = [name stringByAppendingString:text];
-                /*if ([fullText length] > 50) {
-                    text = [[text substringToIndex: (50 - [name length])] stringByAppendingString:@"[...]"];
-                }*/
-                [boldText appendAttributedString:[[NSAttributedString alloc] initWithString:text]];
-                _chatContentLabel.text = nil;
-                _chatContentLabel.attributedText = boldText;
-            }
-
-            
-            LinphoneChatMessageState state = linphone_chat_message_get_state(last_msg);
-            if (outgoing && (state == LinphoneChatMessageStateDeliveredToUser || state == LinphoneChatMessageStateDisplayed || state == LinphoneChatMessageStateNotDelivered || state == LinphoneChatMessageStateFileTransferError)) {
-                [self displayImdmStatus:state];
-                CGRect newFrame = _chatContentLabel.frame;
-                newFrame.origin.x = 89;
-                _chatContentLabel.frame = newFrame;
-            } else {
-                // We displace the message 20 pixels to the left
-                [_imdmIcon setHidden:TRUE];
-                CGRect newFrame = _chatContentLabel.frame;
-                newFrame.origin.x = 69;
-                _chatContentLabel.frame = newFrame;
-            }
-        } else {
-            NSString *text = [[FastAddressBook displayNameForAddress:linphone_chat_message_get_from_address(last_msg)]
-                              stringByAppendingFormat:@" : %@", [UIChatBubbleTextCell TextMessageForChat:last_msg]];
-            // shorten long messages
-            /*if ([text length] > 50)
-                text = [[text substringToIndex:50] stringByAppendingString:@"[...]"];*/
-            [_imdmIcon setHidden:TRUE];
-            CGRect newFrame = _chatContentLabel.frame;
-            newFrame.origin.x = 69;
-            _chatContentLabel.frame = newFrame;
-            _chatContentLabel.text = text;
-        }
-        
-		linphone_chat_message_unref(last_msg);
-	} else
-		_chatContentLabel.text = nil;
-    
+	[_securityImage setImage:model.securityImage];
+	_chatLatestTimeLabel.text = model.timeText;
+
+	[_imdmIcon setHidden:TRUE];
+	CGRect newFrame = _chatContentLabel.frame;
+	newFrame.origin.x = 69;
+	_chatContentLabel.frame = newFrame;
+	_chatContentLabel.attributedText = nil;
+	_chatContentLabel.text = model.lastMessagePreview;
+
 	[self updateUnreadBadge];
 }
 
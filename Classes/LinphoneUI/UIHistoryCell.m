@@ -105,7 +105,17 @@
 			[displayNameLabel.text stringByAppendingString:[NSString stringWithFormat:@" (%lu)", count]];
 	}
 
-	[_avatarImage setImage:[FastAddressBook imageForAddress:addr] bordered:NO withRoundedRadius:YES];
+	__weak UIHistoryCell *weakSelf = self;
+	LinphoneCallLog *log = callLog;
+	UIImage *avatar = [FastAddressBook thumbnailForAddress:addr
+													  side:_avatarImage.bounds.size.width
+												completion:^(UIImage *thumbnail) {
+												  UIHistoryCell *cell = weakSelf;
+												  // the cell may have been reused meanwhile
+												  if (cell && cell.callLog == log)
+													  [cell.avatarImage setImage:thumbnail bordered:NO withRoundedRadius:YES];
+												}];
+	[_avatarImage setImage:avatar bordered:NO withRoundedRadius:YES];
 }
 
 - (void)setEditing:(BOOL)editing {
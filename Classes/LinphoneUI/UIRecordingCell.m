@@ -22,6 +22,7 @@
 #import "UILabel+Boldify.h"
 #import "Utils.h"
 #import "UILinphoneAudioPlayer.h"
+#import "DateFormatterCache.h"
 
 @implementation UIRecordingCell
 
@@ -62,9 +63,8 @@ static UILinphoneAudioPlayer *player;
     _recording = arecording;
     if(_recording) {
         NSArray *parsedRecording = [LinphoneUtils parseRecordingName:_recording];
-        NSDateFormatter *dateFormat = [[NSDateFormatter alloc] init];
-        [dateFormat setDateFormat:@"HH:mm:ss"];
-        _nameLabel.text = [[[parsedRecording objectAtIndex:0] stringByAppendingString:@" @ "] stringByAppendingString:[dateFormat stringFromDate:[parsedRecording objectAtIndex:1]]];
+        NSString *time = [DateFormatterCache.sharedCache stringFromDate:[parsedRecording objectAtIndex:1] format:@"HH:mm:ss"];
+        _nameLabel.text = [[[parsedRecording objectAtIndex:0] stringByAppendingString:@" @ "] stringByAppendingString:time];
     }
 }
 
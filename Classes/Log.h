@@ -18,8 +18,21 @@
  */
 
 #import "linphone/core.h"
+#import "LogSink.h"
 
-#define LOGV(level, ...) [Log log:level file:__FILE__ line:__LINE__ format:__VA_ARGS__]
+// lowest level of the application logs, set by [Log enableLogs:]
+extern int linphone_iphone_log_level;
+
+static inline BOOL linphone_iphone_log_enabled(OrtpLogLevel level) {
+	return level >= __atomic_load_n(&linphone_iphone_log_level, __ATOMIC_RELAXED);
+}
+
+// the arguments are only evaluated, and the message formatted, when the level is enabled
+#define LOGV(level, ...)                                                                                               \
+	do {                                                                                                               \
+		if (linphone_iphone_log_enabled(level))                                                                        \
+			[Log log:level file:__FILE__ line:__LINE__ format:__VA_ARGS__];                                            \
+	} while (0)
 #define LOGD(...) LOGV(ORTP_DEBUG, __VA_ARGS__)
 #define LOGI(...) LOGV(ORTP_MESSAGE, __VA_ARGS__)
 #define LOGW(...) LOGV(ORTP_WARNING, __VA_ARGS__)
@@ -32,6 +45,11 @@
 + (void)log:(OrtpLogLevel)severity file:(const char *)file line:(int)line format:(NSString *)format, ...;
 + (void)enableLogs:(OrtpLogLevel)level;
 + (void)directLog:(OrtpLogLevel)level text:(NSString *)text;
+/* Console output goes through a buffer of capacity lines, see LogSink. Only taken into account before the first
+ * log line is output. */
++ (void)configureOutputWithCapacity:(NSUInteger)capacity overflowPolicy:(LogSinkOverflowPolicy)policy;
+/* waits for the buffered log lines to be output */
++ (void)flush;
 
 void linphone_iphone_log_handler(const char *domain, OrtpLogLevel lev, const char *fmt, va_list args);
 @end
\ No newline at end of file
@@ -23,6 +23,9 @@
 #import "PhoneMainView.h"
 #import "Utils.h"
 
+// sections of the list, recordings are grouped by day
+#define RECORDINGS_DAY_FORMAT @"EEEE, MMM d, yyyy"
+
 @implementation RecordingsListTableView
 
 #pragma mark - Lifecycle Functions
@@ -82,9 +85,7 @@
             continue;
         }
         NSArray *parsedName = [LinphoneUtils parseRecordingName:file];
-        NSDateFormatter *dateFormat = [[NSDateFormatter alloc] init];
-        [dateFormat setDateFormat:@"EEEE, MMM d, yyyy"];
-        NSString *dayPretty = [dateFormat stringFromDate:[parsedName objectAtIndex:1]];
+        NSString *dayPretty = [DateFormatterCache.sharedCache stringFromDate:[parsedName objectAtIndex:1] format:RECORDINGS_DAY_FORMAT];
         NSMutableArray *recOfDay = [recordings objectForKey:dayPretty];
         if (recOfDay) {
             // Loop through the object until a later object, then insert it right before
@@ -228,9 +229,7 @@ forRowAtIndexPath:(NSIndexPath *)indexPath {
 
 - (void)setSelected:(NSString *)filepath {
     NSArray *parsedName = [LinphoneUtils parseRecordingName:filepath];
-    NSDateFormatter *dateFormat = [[NSDateFormatter alloc] init];
-    [dateFormat setDateFormat:@"EEEE, MMM d, yyyy"];
-    NSString *dayPretty = [dateFormat stringFromDate:[parsedName objectAtIndex:1]];
+    NSString *dayPretty = [DateFormatterCache.sharedCache stringFromDate:[parsedName objectAtIndex:1] format:RECORDINGS_DAY_FORMAT];
     NSUInteger section;
     NSArray *keys = [recordings allKeys];
     for (section = 0; section < [keys count]; ++section) {
@@ -253,10 +252,8 @@ forRowAtIndexPath:(NSIndexPath *)indexPath {
 
 - (NSArray *)getSortedKeys {
     return [[recordings allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString *day2, NSString *day1){
-        NSDateFormatter *dateFormat = [[NSDateFormatter alloc] init];
-        [dateFormat setDateFormat:@"EEEE, MMM d, yyyy"];
-        NSDate *date1 = [dateFormat dateFromString:day1];
-        NSDate *date2 = [dateFormat dateFromString:day2];
+        NSDate *date1 = [DateFormatterCache.sharedCache dateFromString:day1 format:RECORDINGS_DAY_FORMAT];
+        NSDate *date2 = [DateFormatterCache.sharedCache dateFromString:day2 format:RECORDINGS_DAY_FORMAT];
         return [date1 compare:date2];
     }];
 }
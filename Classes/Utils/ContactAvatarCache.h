@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <UIKit/UIKit.h>
+
+@class Contact;
+
+/*
+ * Contact avatars as shown in the lists: square cropped, scaled down to the size of the cell and already decoded.
+ * Thumbnails are generated in the background from the image data, which is only fetched from the contact store at
+ * that time. The cache is bounded by the memory the thumbnails take and emptied on memory warnings.
+ * The image data fetched from the contact store is kept too, in a smaller cache, for the views showing full avatars.
+ * Must be used from the main thread, except avatarDataForIdentifier:.
+ */
+@interface ContactAvatarCache : NSObject
+
++ (ContactAvatarCache *)sharedCache;
+
+/* Returns the thumbnail when it is ready. Otherwise returns nil and, if the contact has an avatar, generates it and
+ * hands it over to completion, on the main thread. */
+- (UIImage *)thumbnailForContact:(Contact *)contact
+							side:(CGFloat)side
+					  completion:(void (^)(UIImage *thumbnail))completion;
+/* encoded avatar of a native contact, nil if it has none. Can be called from any thread */
+- (NSData *)avatarDataForIdentifier:(NSString *)identifier;
+/* the avatar of the contact changed */
+- (void)removeThumbnailForIdentifier:(NSString *)identifier;
+- (void)clear;
+
+@property(readonly) unsigned long hits;
+@property(readonly) unsigned long misses;
+
+@end
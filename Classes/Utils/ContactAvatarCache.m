@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <ImageIO/ImageIO.h>
+
+#import "ContactAvatarCache.h"
+#import "Contact.h"
+#import "LinphoneManager.h"
+#import "Log.h"
+
+// decoded bytes, about 300 thumbnails of a list cell on a 3x screen
+#define CONTACT_AVATAR_CACHE_COST (16 * 1024 * 1024)
+// encoded bytes
+#define CONTACT_AVATAR_DATA_CACHE_COST (8 * 1024 * 1024)
+
+@interface ContactAvatarEntry : NSObject
+// nil when the contact has no avatar, so that we do not look for it again
+@property(strong) UIImage *thumbnail;
+@property CGFloat side;
+@end
+
+@implementation ContactAvatarEntry
+@end
+
+@implementation ContactAvatarCache {
+	NSCache<NSString *, ContactAvatarEntry *> *entries;
+	// identifier -> completions waiting for a thumbnail being generated
+	NSMutableDictionary<NSString *, NSMutableArray *> *pending;
+	// bumped by clear: thumbnails generated before are still handed over, but no longer kept
+	NSUInteger generation;
+	dispatch_queue_t queue;
+	// identifier -> NSData, or NSNull when the contact has no avatar
+	NSCache<NSString *, id> *avatarData;
+	// bumped each time avatar data is dropped, so that a fetch running meanwhile does not store a stale one
+	NSUInteger avatarDataGeneration;
+}
+
++ (ContactAvatarCache *)sharedCache {
+	static ContactAvatarCache *sharedCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedCache = [[ContactAvatarCache alloc] init];
+	});
+	return sharedCache;
+}
+
+- (instancetype)init {
+	if ((self = [super init])) {
+		entries = [[NSCache alloc] init];
+		entries.totalCostLimit = CONTACT_AVATAR_CACHE_COST;
+		pending = [NSMutableDictionary dictionary];
+		avatarData = [[NSCache alloc] init];
+		avatarData.totalCostLimit = CONTACT_AVATAR_DATA_CACHE_COST;
+		queue = dispatch_queue_create("org.linphone.avatars", DISPATCH_QUEUE_CONCURRENT);
+		[NSNotificationCenter.defaultCenter addObserver:self
+											   selector:@selector(clear)
+												   name:UIApplicationDidReceiveMemoryWarningNotification
+												 object:nil];
+	}
+	return self;
+}
+
+- (void)dealloc {
+	[NSNotificationCenter.defaultCenter removeObserver:self];
+}
+
+static UIImage *createThumbnail(NSData *data, CGFloat side, CGFloat scale) {
+	CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+	if (!source)
+		return nil;
+	// the thumbnail is cropped to a square afterwards, its short edge must keep the requested size
+	NSDictionary *properties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+	CGFloat width = [properties[(NSString *)kCGImagePropertyPixelWidth] doubleValue];
+	CGFloat height = [properties[(NSString *)kCGImagePropertyPixelHeight] doubleValue];
+	CGFloat ratio = (width > 0 && height > 0) ? MAX(width, height) / MIN(width, height) : 1;
+	NSDictionary *options = @{
+		(NSString *)kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+		(NSString *)kCGImageSourceCreateThumbnailWithTransform : @YES,
+		(NSString *)kCGImageSourceThumbnailMaxPixelSize : @(ceil(side * scale * ratio))
+	};
+	CGImageRef image = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+	CFRelease(source);
+	if (!image)
+		return nil;
+
+	size_t imageWidth = CGImageGetWidth(image);
+	size_t imageHeight = CGImageGetHeight(image);
+	size_t edge = MIN(imageWidth, imageHeight);
+	CGImageRef square =
+		CGImageCreateWithImageInRect(image, CGRectMake((imageWidth - edge) / 2, (imageHeight - edge) / 2, edge, edge));
+	CGImageRelease(image);
+	if (!square)
+		return nil;
+
+	// drawing it at its final size decodes it here rather than when the cell is displayed
+	UIGraphicsBeginImageContextWithOptions(CGSizeMake(side, side), NO, scale);
+	[[UIImage imageWithCGImage:square] drawInRect:CGRectMake(0, 0, side, side)];
+	UIImage *thumbnail = UIGraphicsGetImageFromCurrentImageContext();
+	UIGraphicsEndImageContext();
+	CGImageRelease(square);
+	return thumbnail;
+}
+
+- (UIImage *)thumbnailForContact:(Contact *)contact
+							side:(CGFloat)side
+					  completion:(void (^)(UIImage *thumbnail))completion {
+	NSString *identifier = contact.identifier;
+	// only native contacts have an avatar
+	if (!contact.person || !identifier || side <= 0)
+		return nil;
+
+	ContactAvatarEntry *entry = [entries objectForKey:identifier];
+	if (entry && (!entry.thumbnail || entry.side >= side)) {
+		_hits++;
+		return entry.thumbnail;
+	}
+	_misses++;
+
+	NSMutableArray *completions = pending[identifier];
+	if (completions) {
+		if (completion)
+			[completions addObject:completion];
+		return nil;
+	}
+	completions = [NSMutableArray array];
+	if (completion)
+		[completions addObject:completion];
+	pending[identifier] = completions;
+
+	CGFloat scale = UIScreen.mainScreen.scale;
+	NSUInteger requestGeneration = generation;
+	dispatch_async(queue, ^{
+		NSData *data = [contact avatarData];
+		UIImage *thumbnail = data ? createThumbnail(data, side, scale) : nil;
+		dispatch_async(dispatch_get_main_queue(), ^{
+			// removed meanwhile, the avatar may have changed and a new request may be running
+			if (pending[identifier] != completions)
+				return;
+			[pending removeObjectForKey:identifier];
+			if (requestGeneration == generation) {
+				ContactAvatarEntry *newEntry = [[ContactAvatarEntry alloc] init];
+				newEntry.thumbnail = thumbnail;
+				newEntry.side = side;
+				CGImageRef image = thumbnail.CGImage;
+				[entries setObject:newEntry
+							forKey:identifier
+							  cost:image ? CGImageGetBytesPerRow(image) * CGImageGetHeight(image) : 0];
+			}
+			if (!thumbnail)
+				return;
+			for (void (^block)(UIImage *) in completions)
+				block(thumbnail);
+		});
+	});
+	return nil;
+}
+
+- (NSData *)avatarDataForIdentifier:(NSString *)identifier {
+	if (!identifier)
+		return nil;
+	id cached = [avatarData objectForKey:identifier];
+	if (cached)
+		return cached == NSNull.null ? nil : cached;
+
+	NSUInteger fetchGeneration;
+	@synchronized(self) {
+		fetchGeneration = avatarDataGeneration;
+	}
+	NSData *data = [LinphoneManager.instance.fastAddressBook imageDataForIdentifier:identifier];
+	@synchronized(self) {
+		if (fetchGeneration == avatarDataGeneration)
+			[avatarData setObject:data ?: NSNull.null forKey:identifier cost:data.length];
+	}
+	return data;
+}
+
+- (void)removeThumbnailForIdentifier:(NSString *)identifier {
+	if (!identifier)
+		return;
+	[entries removeObjectForKey:identifier];
+	[pending removeObjectForKey:identifier];
+	@synchronized(self) {
+		[avatarData removeObjectForKey:identifier];
+		avatarDataGeneration++;
+	}
+}
+
+- (void)clear {
+	LOGI(@"Contact avatar cache: %lu hits, %lu misses", _hits, _misses);
+	[entries removeAllObjects];
+	generation++;
+	@synchronized(self) {
+		[avatarData removeAllObjects];
+		avatarDataGeneration++;
+	}
+}
+
+@end
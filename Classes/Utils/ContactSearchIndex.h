@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class Contact;
+
+/*
+ * Contacts matching a search query, ranked: display name starting with the query first, then display name containing
+ * it, then email address or phone number containing it. Contacts keep the order they were given in within a rank.
+ * Names, addresses and numbers are folded (case, diacritics, number separators) once, when the index is built. A
+ * query extending the previous one only goes through the previous matches.
+ * Not thread safe: build and search it from one queue at a time.
+ */
+@interface ContactSearchIndex : NSObject
+
+/* names are the display names of the contacts, in the same order: they are read from the main thread */
+- (instancetype)initWithContacts:(NSArray<Contact *> *)contacts names:(NSArray<NSString *> *)names;
+- (NSArray<Contact *> *)search:(NSString *)query;
+
+@property(readonly) NSUInteger count;
+
+@end
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+
+#import "ContactSearchIndex.h"
+#import "Contact.h"
+#import "Log.h"
+
+@interface ContactSearchEntry : NSObject
+@property(strong) Contact *contact;
+@property(strong) NSString *name;
+// emails and phone numbers, one per line
+@property(strong) NSString *details;
+@end
+
+@implementation ContactSearchEntry
+@end
+
+@implementation ContactSearchIndex {
+	NSArray<ContactSearchEntry *> *entries;
+	NSString *lastQuery;
+	// entries matching lastQuery, in index order
+	NSArray<ContactSearchEntry *> *lastMatches;
+}
+
+static NSString *fold(NSString *string) {
+	return [string stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch locale:nil];
+}
+
+static NSCharacterSet *numberSeparators(void) {
+	static NSCharacterSet *separators;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+	  separators = [NSCharacterSet characterSetWithCharactersInString:@" -.()/"];
+	});
+	return separators;
+}
+
+// "+33 6-12 (34)" is searched as "+3361234"
+static NSString *foldNumber(NSString *number) {
+	return [[number componentsSeparatedByCharactersInSet:numberSeparators()] componentsJoinedByString:@""];
+}
+
+// only digits, '+' and separators, the query is also looked for in the folded numbers
+static BOOL isNumberQuery(NSString *query) {
+	static NSCharacterSet *notNumber;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+	  NSMutableCharacterSet *number = [NSMutableCharacterSet characterSetWithCharactersInString:@"+0123456789"];
+	  [number formUnionWithCharacterSet:numberSeparators()];
+	  notNumber = number.invertedSet;
+	});
+	return query.length > 0 && [query rangeOfCharacterFromSet:notNumber].location == NSNotFound;
+}
+
+- (instancetype)initWithContacts:(NSArray<Contact *> *)contacts names:(NSArray<NSString *> *)names {
+	if ((self = [super init])) {
+		NSMutableArray<ContactSearchEntry *> *newEntries = [NSMutableArray arrayWithCapacity:contacts.count];
+		for (NSUInteger i = 0; i < contacts.count; i++) {
+			Contact *contact = contacts[i];
+			ContactSearchEntry *entry = [[ContactSearchEntry alloc] init];
+			entry.contact = contact;
+			entry.name = fold(names[i]);
+			NSMutableArray<NSString *> *details = [NSMutableArray array];
+			for (NSString *email in contact.emails)
+				[details addObject:fold(email)];
+			for (NSString *phone in contact.phones)
+				[details addObject:foldNumber(phone)];
+			entry.details = [details componentsJoinedByString:@"\n"];
+			[newEntries addObject:entry];
+		}
+		entries = newEntries;
+	}
+	return self;
+}
+
+- (NSUInteger)count {
+	return entries.count;
+}
+
+- (NSArray<Contact *> *)search:(NSString *)query {
+	CFTimeInterval start = CACurrentMediaTime();
+	NSString *folded = fold(query ?: @"");
+	NSString *number = isNumberQuery(folded) ? foldNumber(folded) : nil;
+	// every match of "abc" also matches "ab"
+	BOOL narrowing = lastQuery.length > 0 && [folded hasPrefix:lastQuery];
+	NSArray<ContactSearchEntry *> *candidates = narrowing ? lastMatches : entries;
+
+	NSMutableArray<ContactSearchEntry *> *matches = [NSMutableArray array];
+	NSMutableArray<Contact *> *begin = [NSMutableArray array];
+	NSMutableArray<Contact *> *contain = [NSMutableArray array];
+	NSMutableArray<Contact *> *details = [NSMutableArray array];
+	for (ContactSearchEntry *entry in candidates) {
+		if (folded.length == 0 || [entry.name hasPrefix:folded])
+			[begin addObject:entry.contact];
+		else if ([entry.name rangeOfString:folded].location != NSNotFound)
+			[contain addObject:entry.contact];
+		else if ([entry.details rangeOfString:folded].location != NSNotFound ||
+				 (number.length > 0 && [entry.details rangeOfString:number].location != NSNotFound))
+			[details addObject:entry.contact];
+		else
+			continue;
+		[matches addObject:entry];
+	}
+	lastQuery = folded;
+	lastMatches = matches;
+
+	[begin addObjectsFromArray:contain];
+	[begin addObjectsFromArray:details];
+	LOGD(@"Contact search \"%@\": %lu results out of %lu %s in %.1f ms", query, (unsigned long)begin.count,
+		 (unsigned long)candidates.count, narrowing ? "previous matches" : "contacts",
+		 (CACurrentMediaTime() - start) * 1000);
+	return begin;
+}
+
+@end
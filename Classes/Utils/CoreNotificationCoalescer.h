@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+/*
+ * Notifications posted from core callbacks are delivered together once the current main queue block, usually a core
+ * iteration, is over, so that the views do not run in the middle of SIP processing. A queued notification with the same
+ * name and coalescing key is replaced by the new one, and keeps its place in the batch. Must be used from the main
+ * thread.
+ */
+@interface CoreNotificationCoalescer : NSObject
+
+/* key can be nil for notifications which must not be coalesced. release runs once the notification is delivered,
+ * replaced or cancelled: it drops the references which keep the pointers of userInfo valid until then. */
+- (void)postNotificationName:(NSString *)name
+					  object:(id)object
+					userInfo:(NSDictionary *)userInfo
+			   coalescingKey:(id<NSCopying>)key
+					 release:(void (^)(void))release;
+/* deliver the queued notifications at once */
+- (void)flush;
+/* drop the queued notifications, the core is going away */
+- (void)cancel;
+
+@property(readonly) unsigned long posted;
+@property(readonly) unsigned long coalesced;
+@property(readonly) unsigned long batches;
+
+@end
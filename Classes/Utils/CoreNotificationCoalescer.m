@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import "CoreNotificationCoalescer.h"
+
+@interface CoreNotificationEntry : NSObject
+@property(strong) NSString *name;
+@property(strong) id object;
+@property(strong) NSDictionary *userInfo;
+@property(copy) void (^release)(void);
+@end
+
+@implementation CoreNotificationEntry
+@end
+
+@implementation CoreNotificationCoalescer {
+	NSMutableArray<CoreNotificationEntry *> *entries;
+	NSMutableDictionary<NSArray *, CoreNotificationEntry *> *entriesByKey;
+	// tells the scheduled flush apart from the ones done or cancelled before it ran
+	unsigned long generation;
+}
+
+- (instancetype)init {
+	if ((self = [super init])) {
+		entries = [NSMutableArray array];
+		entriesByKey = [NSMutableDictionary dictionary];
+	}
+	return self;
+}
+
+- (void)postNotificationName:(NSString *)name
+					  object:(id)object
+					userInfo:(NSDictionary *)userInfo
+			   coalescingKey:(id<NSCopying>)key
+					 release:(void (^)(void))release {
+	_posted++;
+	NSArray *entryKey = key ? @[ name, key ] : nil;
+	CoreNotificationEntry *entry = entryKey ? entriesByKey[entryKey] : nil;
+	if (entry) {
+		_coalesced++;
+		if (entry.release)
+			entry.release();
+	} else {
+		entry = [[CoreNotificationEntry alloc] init];
+		entry.name = name;
+		[entries addObject:entry];
+		if (entryKey)
+			entriesByKey[entryKey] = entry;
+	}
+	entry.object = object;
+	entry.userInfo = userInfo;
+	entry.release = release;
+
+	if (entries.count > 1)
+		return;
+	unsigned long scheduled = ++generation;
+	__weak CoreNotificationCoalescer *weakSelf = self;
+	dispatch_async(dispatch_get_main_queue(), ^{
+	  CoreNotificationCoalescer *strongSelf = weakSelf;
+	  if (strongSelf && strongSelf->generation == scheduled)
+		  [strongSelf flush];
+	});
+}
+
+- (void)flush {
+	if (entries.count == 0)
+		return;
+	// observers may post again while the batch is delivered, the new notifications go to the next batch
+	NSArray<CoreNotificationEntry *> *batch = entries;
+	entries = [NSMutableArray array];
+	[entriesByKey removeAllObjects];
+	generation++;
+
+	_batches++;
+	for (CoreNotificationEntry *entry in batch) {
+		[NSNotificationCenter.defaultCenter postNotificationName:entry.name object:entry.object userInfo:entry.userInfo];
+		if (entry.release)
+			entry.release();
+	}
+}
+
+- (void)cancel {
+	NSArray<CoreNotificationEntry *> *batch = entries;
+	entries = [NSMutableArray array];
+	[entriesByKey removeAllObjects];
+	generation++;
+	for (CoreNotificationEntry *entry in batch) {
+		if (entry.release)
+			entry.release();
+	}
+}
+
+@end
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSInteger, CoreSchedulerMode) {
+	/* historical behaviour: iterate at a fixed 20 ms period */
+	CoreSchedulerModeTimer = 0,
+	/* iterate fast while there is activity (calls, transfers, pending registrations), slowly when idle, in foreground
+	 * too, and immediately on wakeUp */
+	CoreSchedulerModeAdaptive
+};
+
+/* Tells the scheduler whether the core currently needs the fast period. Called on the scheduler queue after each
+ * iteration. */
+typedef BOOL (^CoreSchedulerActivityBlock)(void);
+
+/*
+ * CoreScheduler drives linphone_core_iterate(). It replaces the repeating NSTimer of LinphoneManager with a
+ * dispatch timer whose period adapts to the core activity, and keeps some statistics (wakeups, iterate latency)
+ * so that both strategies can be compared from the logs.
+ */
+@interface CoreScheduler : NSObject
+
+- (instancetype)initWithMode:(CoreSchedulerMode)mode queue:(dispatch_queue_t)queue iterate:(dispatch_block_t)iterate;
+
+- (void)start;
+- (void)stop;
+/* Request an iteration as soon as possible, and switch back to the fast period. Can be called from any thread. */
+- (void)wakeUp;
+
+- (void)resetStatistics;
+- (NSString *)statisticsDescription;
+
+@property(readonly) CoreSchedulerMode mode;
+@property(readonly) dispatch_queue_t queue;
+@property(readonly) BOOL running;
+@property(copy) CoreSchedulerActivityBlock activity;
+/* periods in seconds, only used in adaptive mode */
+@property NSTimeInterval fastPeriod;
+@property NSTimeInterval idlePeriod;
+/* time spent in fast period after the last activity or wakeUp, before going back to idle */
+@property NSTimeInterval fastPeriodGrace;
+
+@property(readonly) unsigned long wakeups;
+@property(readonly) unsigned long explicitWakeups;
+/* share of the time spent in the idle period, and mean wakeup rate, since the statistics were reset */
+@property(readonly) double idleRatio;
+@property(readonly) double wakeupsPerSecond;
+@property(readonly) NSTimeInterval averageIterateLatency;
+@property(readonly) NSTimeInterval maxIterateLatency;
+
+@end
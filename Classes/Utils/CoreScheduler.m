@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <QuartzCore/QuartzCore.h>
+#include <stdatomic.h>
+
+#import "CoreScheduler.h"
+#import "Log.h"
+
+#define CORE_SCHEDULER_FAST_PERIOD 0.02
+#define CORE_SCHEDULER_IDLE_PERIOD 0.2
+#define CORE_SCHEDULER_FAST_GRACE 2.0
+// statistics are dumped in the logs every STATS_LOG_INTERVAL seconds
+#define CORE_SCHEDULER_STATS_LOG_INTERVAL 300
+
+@implementation CoreScheduler {
+	dispatch_block_t iterateBlock;
+	dispatch_source_t timer;
+	NSTimeInterval currentPeriod;
+	CFTimeInterval lastActivity;
+	CFTimeInterval lastStatsLog;
+	CFTimeInterval lastFire;
+	CFTimeInterval statsStart;
+	CFTimeInterval idleTime;
+	CFTimeInterval totalLatency;
+	// set when a wakeUp is pending on the queue, so that bursts of wakeUp are coalesced into one iteration
+	atomic_bool wakeUpPending;
+}
+
+- (instancetype)initWithMode:(CoreSchedulerMode)mode queue:(dispatch_queue_t)queue iterate:(dispatch_block_t)iterate {
+	if ((self = [super init])) {
+		_mode = mode;
+		_queue = queue ?: dispatch_get_main_queue();
+		iterateBlock = [iterate copy];
+		_fastPeriod = CORE_SCHEDULER_FAST_PERIOD;
+		_idlePeriod = CORE_SCHEDULER_IDLE_PERIOD;
+		_fastPeriodGrace = CORE_SCHEDULER_FAST_GRACE;
+		[self resetStatistics];
+	}
+	return self;
+}
+
+- (void)dealloc {
+	[self stop];
+}
+
+#pragma mark - Scheduling
+
+- (void)start {
+	if (_running)
+		return;
+	_running = TRUE;
+	lastActivity = lastStatsLog = lastFire = statsStart = CACurrentMediaTime();
+	currentPeriod = _fastPeriod;
+	timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+	__weak CoreScheduler *weakSelf = self;
+	dispatch_source_set_event_handler(timer, ^{
+		[weakSelf fire:NO];
+	});
+	[self armTimer];
+	dispatch_resume(timer);
+	LOGI(@"Core scheduler started in %@ mode", _mode == CoreSchedulerModeAdaptive ? @"adaptive" : @"timer");
+}
+
+- (void)stop {
+	if (!_running)
+		return;
+	_running = FALSE;
+	dispatch_source_cancel(timer);
+	timer = nil;
+	LOGI(@"Core scheduler stopped: %@", [self statisticsDescription]);
+}
+
+- (void)armTimer {
+	uint64_t interval = (uint64_t)(currentPeriod * NSEC_PER_SEC);
+	// in idle mode let the system coalesce our wakeups with other timers
+	uint64_t leeway = (currentPeriod > _fastPeriod) ? interval / 4 : interval / 10;
+	dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)interval), interval, leeway);
+}
+
+- (void)wakeUp {
+	if (!_running || _mode != CoreSchedulerModeAdaptive)
+		return;
+	if (atomic_exchange(&wakeUpPending, true))
+		return;
+	dispatch_async(_queue, ^{
+		atomic_store(&wakeUpPending, false);
+		if (self.running)
+			[self fire:YES];
+	});
+}
+
+- (void)fire:(BOOL)explicit {
+	CFTimeInterval start = CACurrentMediaTime();
+	iterateBlock();
+	CFTimeInterval end = CACurrentMediaTime();
+	CFTimeInterval latency = end - start;
+
+	_wakeups++;
+	if (explicit)
+		_explicitWakeups++;
+	// the time since the previous wakeup was spent waiting for the period armed then
+	if (currentPeriod > _fastPeriod)
+		idleTime += start - lastFire;
+	lastFire = end;
+	totalLatency += latency;
+	_maxIterateLatency = MAX(_maxIterateLatency, latency);
+
+	if (end - lastStatsLog > CORE_SCHEDULER_STATS_LOG_INTERVAL) {
+		lastStatsLog = end;
+		LOGI(@"Core scheduler statistics: %@", [self statisticsDescription]);
+	}
+
+	if (_mode != CoreSchedulerModeAdaptive || !_running)
+		return;
+
+	if (explicit || (_activity && _activity()))
+		lastActivity = end;
+	NSTimeInterval period = (end - lastActivity < _fastPeriodGrace) ? _fastPeriod : _idlePeriod;
+	if (explicit || period != currentPeriod) {
+		currentPeriod = period;
+		[self armTimer];
+	}
+}
+
+#pragma mark - Statistics
+
+- (NSTimeInterval)averageIterateLatency {
+	return _wakeups ? totalLatency / _wakeups : 0;
+}
+
+- (double)idleRatio {
+	CFTimeInterval elapsed = lastFire - statsStart;
+	return elapsed > 0 ? idleTime / elapsed : 0;
+}
+
+- (double)wakeupsPerSecond {
+	CFTimeInterval elapsed = lastFire - statsStart;
+	return elapsed > 0 ? _wakeups / elapsed : 0;
+}
+
+- (void)resetStatistics {
+	_wakeups = _explicitWakeups = 0;
+	totalLatency = _maxIterateLatency = 0;
+	idleTime = 0;
+	statsStart = lastFire = CACurrentMediaTime();
+}
+
+- (NSString *)statisticsDescription {
+	// in idle period, incoming traffic waits up to one period before being processed
+	return [NSString stringWithFormat:@"%lu wakeups (%lu explicit, %.1f/s), idle %.0f%% of the time, iterate latency "
+									  @"avg %.3f ms / max %.3f ms, current period %.0f ms",
+									  _wakeups, _explicitWakeups, self.wakeupsPerSecond, self.idleRatio * 100.,
+									  self.averageIterateLatency * 1000., _maxIterateLatency * 1000.,
+									  currentPeriod * 1000.];
+}
+
+@end
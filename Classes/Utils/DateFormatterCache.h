@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/*
+ * Date formatters shared by the whole application. Creating an NSDateFormatter is expensive and most of them were
+ * created for a single date, once per row of the lists. Formatters are kept per format and locale, and dropped when
+ * the locale or the time zone changes. The bounds of the current day and year are also kept, so that telling whether
+ * a date is today does not go through the calendar each time.
+ * Can be used from any thread. The formatters returned must not be modified.
+ */
+@interface DateFormatterCache : NSObject
+
++ (DateFormatterCache *)sharedCache;
+
+/* formatter of the current locale */
+- (NSDateFormatter *)formatterWithFormat:(NSString *)format;
+/* locale identifier may be nil for the current locale */
+- (NSDateFormatter *)formatterWithFormat:(NSString *)format localeIdentifier:(NSString *)localeIdentifier;
+- (NSString *)stringFromDate:(NSDate *)date format:(NSString *)format;
+- (NSDate *)dateFromString:(NSString *)string format:(NSString *)format;
+/* "12s" like, for the background time remaining in the logs */
+- (NSString *)stringFromTimeInterval:(NSTimeInterval)interval;
+
+- (BOOL)isDateToday:(NSDate *)date;
+- (BOOL)isDateYesterday:(NSDate *)date;
+- (BOOL)isDateInCurrentYear:(NSDate *)date;
+
+- (void)clear;
+
+@property(readonly) unsigned long hits;
+@property(readonly) unsigned long misses;
+
+@end
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#import <UIKit/UIKit.h>
+
+#import "DateFormatterCache.h"
+#import "Log.h"
+
+@implementation DateFormatterCache {
+	// "<locale>|<format>" -> formatter
+	NSMutableDictionary<NSString *, NSDateFormatter *> *formatters;
+	NSDateComponentsFormatter *intervalFormatter;
+	// bounds of the current day and year, valid until dayEnd
+	NSTimeInterval yesterdayStart, dayStart, dayEnd, yearStart, yearEnd;
+	NSObject *lock;
+}
+
++ (DateFormatterCache *)sharedCache {
+	static DateFormatterCache *sharedCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedCache = [[DateFormatterCache alloc] init];
+	});
+	return sharedCache;
+}
+
+- (instancetype)init {
+	if ((self = [super init])) {
+		formatters = [NSMutableDictionary dictionary];
+		lock = [[NSObject alloc] init];
+		for (NSString *name in @[
+				 NSCurrentLocaleDidChangeNotification, NSSystemTimeZoneDidChangeNotification,
+				 UIApplicationSignificantTimeChangeNotification
+			 ]) {
+			[NSNotificationCenter.defaultCenter addObserver:self selector:@selector(clear) name:name object:nil];
+		}
+	}
+	return self;
+}
+
+- (void)dealloc {
+	[NSNotificationCenter.defaultCenter removeObserver:self];
+}
+
+- (NSDateFormatter *)formatterWithFormat:(NSString *)format {
+	return [self formatterWithFormat:format localeIdentifier:nil];
+}
+
+- (NSDateFormatter *)formatterWithFormat:(NSString *)format localeIdentifier:(NSString *)localeIdentifier {
+	NSString *key = [NSString stringWithFormat:@"%@|%@", localeIdentifier ?: @"", format];
+	@synchronized(lock) {
+		NSDateFormatter *formatter = formatters[key];
+		if (formatter) {
+			_hits++;
+			return formatter;
+		}
+		_misses++;
+		formatter = [[NSDateFormatter alloc] init];
+		if (localeIdentifier)
+			formatter.locale = [NSLocale localeWithLocaleIdentifier:localeIdentifier];
+		formatter.dateFormat = format;
+		formatters[key] = formatter;
+		return formatter;
+	}
+}
+
+- (NSString *)stringFromDate:(NSDate *)date format:(NSString *)format {
+	// formatters are thread safe as long as they are not modified
+	return [[self formatterWithFormat:format] stringFromDate:date];
+}
+
+- (NSDate *)dateFromString:(NSString *)string format:(NSString *)format {
+	return [[self formatterWithFormat:format] dateFromString:string];
+}
+
+- (NSString *)stringFromTimeInterval:(NSTimeInterval)interval {
+	NSDateComponentsFormatter *formatter;
+	@synchronized(lock) {
+		if (!intervalFormatter) {
+			intervalFormatter = [[NSDateComponentsFormatter alloc] init];
+			intervalFormatter.allowedUnits = NSCalendarUnitSecond;
+			intervalFormatter.unitsStyle = NSDateComponentsFormatterUnitsStyleAbbreviated;
+			intervalFormatter.zeroFormattingBehavior = NSDateComponentsFormatterZeroFormattingBehaviorDropAll;
+		}
+		formatter = intervalFormatter;
+	}
+	return [formatter stringFromTimeInterval:interval];
+}
+
+// must be called with the lock held
+- (void)updateDayBounds {
+	NSDate *now = [NSDate date];
+	if (now.timeIntervalSinceReferenceDate < dayEnd && now.timeIntervalSinceReferenceDate >= dayStart)
+		return;
+	NSCalendar *calendar = [NSCalendar currentCalendar];
+	NSDate *start;
+	NSTimeInterval length;
+	[calendar rangeOfUnit:NSCalendarUnitDay startDate:&start interval:&length forDate:now];
+	dayStart = start.timeIntervalSinceReferenceDate;
+	dayEnd = dayStart + length;
+	yesterdayStart = [calendar dateByAddingUnit:NSCalendarUnitDay value:-1 toDate:start options:0]
+						 .timeIntervalSinceReferenceDate;
+	[calendar rangeOfUnit:NSCalendarUnitYear startDate:&start interval:&length forDate:now];
+	yearStart = start.timeIntervalSinceReferenceDate;
+	yearEnd = yearStart + length;
+}
+
+- (BOOL)isDateToday:(NSDate *)date {
+	NSTimeInterval time = date.timeIntervalSinceReferenceDate;
+	@synchronized(lock) {
+		[self updateDayBounds];
+		return time >= dayStart && time < dayEnd;
+	}
+}
+
+- (BOOL)isDateYesterday:(NSDate *)date {
+	NSTimeInterval time = date.timeIntervalSinceReferenceDate;
+	@synchronized(lock) {
+		[self updateDayBounds];
+		return time >= yesterdayStart && time < dayStart;
+	}
+}
+
+- (BOOL)isDateInCurrentYear:(NSDate *)date {
+	NSTimeInterval time = date.timeIntervalSinceReferenceDate;
+	@synchronized(lock) {
+		[self updateDayBounds];
+		return time >= yearStart && time < yearEnd;
+	}
+}
+
+- (void)clear {
+	@synchronized(lock) {
+		LOGI(@"Date formatter cache: %lu formatters, %lu hits, %lu misses", (unsigned long)formatters.count, _hits,
+			 _misses);
+		// formatters copied the time zone when they were created
+		[NSTimeZone resetSystemTimeZone];
+		[formatters removeAllObjects];
+		intervalFormatter = nil;
+		dayStart = dayEnd = 0;
+	}
+}
+
+@end
@@ -23,12 +23,21 @@
 #include "linphone/linphonecore.h"
 #include "Contact.h"
 
+@class FriendListSubscriptionCoalescer;
+
 @interface FastAddressBook : NSObject
 
-@property(readonly, nonatomic) NSMutableDictionary *addressBookMap;
-@property BOOL needToUpdate;
+/* normalized address -> contact. An immutable snapshot, replaced as a whole when contacts change: lookups need no
+ * lock, and several lookups made on the same snapshot are consistent */
+@property(readonly, atomic) NSDictionary<NSString *, Contact *> *addressBookMap;
+/* friend list changes go through it, rather than refreshing the subscriptions each time */
+@property(readonly) FriendListSubscriptionCoalescer *subscriptionCoalescer;
 
+/* reload every contact */
 - (void) fetchContactsInBackGroundThread;
+/* reload the native contacts added, changed or removed since the last load, kLinphoneAddressBookUpdate is then posted
+ * with their count in its userInfo ("added", "changed" and "removed") */
+- (void)syncContacts;
 - (BOOL)deleteContact:(Contact *)contact;
 - (BOOL)deleteCNContact:(CNContact *)CNContact;
 - (BOOL)deleteAllContacts;
@@ -45,6 +54,12 @@
 + (UIImage *)imageForContact:(Contact *)contact;
 + (UIImage *)imageForAddress:(const LinphoneAddress *)addr;
 + (UIImage *)imageForSecurityLevel:(LinphoneChatRoomSecurityLevel)level;
+/* avatar thumbnail for list cells: the placeholder is returned until it is ready, completion then gets it on the main
+ * thread */
++ (UIImage *)thumbnailForContact:(Contact *)contact side:(CGFloat)side completion:(void (^)(UIImage *image))completion;
++ (UIImage *)thumbnailForAddress:(const LinphoneAddress *)addr side:(CGFloat)side completion:(void (^)(UIImage *image))completion;
+/* fetched from the contact store, the address book is loaded without avatars. Can be called from any thread */
+- (NSData *)imageDataForIdentifier:(NSString *)identifier;
 
 + (BOOL)contactHasValidSipDomain:(Contact *)person;
 + (BOOL)isSipURIValid:(NSString*)addr;
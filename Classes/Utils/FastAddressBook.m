@@ -21,25 +21,59 @@
 #import <Contacts/Contacts.h>
 #endif
 #import "FastAddressBook.h"
+#import "FriendListSubscriptionCoalescer.h"
 #import "LinphoneManager.h"
 #import "ContactsListView.h"
 #import "Utils.h"
 
+#import <QuartzCore/QuartzCore.h>
+
+@interface FastAddressBook ()
+// atomic: a reader always gets a whole snapshot, without waiting for the writers
+@property(readwrite, atomic) NSDictionary *addressBookMap;
+// username@domain[:port] of the SIP addresses and of the normalized phone numbers -> contact, published along with
+// addressBookMap
+@property(readwrite, atomic) NSDictionary<NSString *, Contact *> *addressIndex;
+@end
+
+// keys a contact is registered with
+@interface ContactKeys : NSObject
+@property(strong) NSArray<NSString *> *mapKeys;
+@property(strong) NSArray<NSString *> *indexKeys;
+@end
+
+@implementation ContactKeys
+@end
+
 @implementation FastAddressBook {
 	CNContactStore* store;
+	// native contacts are synced on this queue, by comparing what the store holds with what we loaded last time
+	dispatch_queue_t syncQueue;
+	BOOL syncScheduled;
+	BOOL reloadAll;
+	// CNContact identifier -> contact, the fields it was built from, and the keys it was registered with in addressBookMap
+	NSMutableDictionary<NSString *, Contact *> *nativeContacts;
+	NSMutableDictionary<NSString *, NSArray *> *fingerprints;
+	NSMutableDictionary<NSString *, ContactKeys *> *contactKeys;
+	// friends which are not native contacts, replaced on each reload
+	NSMapTable<Contact *, ContactKeys *> *friendKeys;
+	// serializes the writers of addressBookMap, readers never take it
+	NSLock *mapLock;
+	// canonical address -> contact or NSNull, for the addresses resolved lately. Emptied when the index changes
+	NSCache<NSString *, id> *resolvedAddresses;
 }
 
+
 + (UIImage *)imageForContact:(Contact *)contact {
-	@synchronized(LinphoneManager.instance.fastAddressBook.addressBookMap) {
-		UIImage *retImage = [contact avatar];
-		if (retImage == nil) {
-			retImage = [UIImage imageNamed:@"avatar.png"];
-		}
-		if (retImage.size.width != retImage.size.height) {
-			retImage = [retImage squareCrop];
-		}
-		return retImage;
+	// the avatar data is kept by ContactAvatarCache, it does not need the map lock
+	UIImage *retImage = [contact avatar];
+	if (retImage == nil) {
+		retImage = [UIImage imageNamed:@"avatar.png"];
+	}
+	if (retImage.size.width != retImage.size.height) {
+		retImage = [retImage squareCrop];
 	}
+	return retImage;
 }
 
 + (UIImage *)imageForAddress:(const LinphoneAddress *)addr {
@@ -49,6 +83,18 @@
 	return [FastAddressBook imageForContact:[FastAddressBook getContactWithAddress:addr]];
 }
 
++ (UIImage *)thumbnailForContact:(Contact *)contact side:(CGFloat)side completion:(void (^)(UIImage *image))completion {
+	return [ContactAvatarCache.sharedCache thumbnailForContact:contact side:side completion:completion]
+		?: [UIImage imageNamed:@"avatar.png"];
+}
+
++ (UIImage *)thumbnailForAddress:(const LinphoneAddress *)addr side:(CGFloat)side completion:(void (^)(UIImage *image))completion {
+	if ([LinphoneManager isMyself:addr] && [LinphoneUtils hasSelfAvatar]) {
+		return [LinphoneUtils selfAvatar];
+	}
+	return [FastAddressBook thumbnailForContact:[FastAddressBook getContactWithAddress:addr] side:side completion:completion];
+}
+
 + (UIImage *)imageForSecurityLevel:(LinphoneChatRoomSecurityLevel)level {
     switch (level) {
         case LinphoneChatRoomSecurityLevelUnsafe:
@@ -65,44 +111,70 @@
 
 + (Contact *)getContact:(NSString *)address {
 	if (LinphoneManager.instance.fastAddressBook != nil) {
-		@synchronized(LinphoneManager.instance.fastAddressBook.addressBookMap) {
-			return [LinphoneManager.instance.fastAddressBook.addressBookMap objectForKey:address];
-		}
+		return [LinphoneManager.instance.fastAddressBook.addressBookMap objectForKey:address];
 	}
   	return nil;
 }
 
+// username@domain[:port]: what identifies a contact address, whatever its scheme, display name and parameters.
+// Addresses without username (sip:domain) are identified by domain[:port], which cannot contain a '@'.
+static NSString *indexKeyForAddress(const LinphoneAddress *address) {
+	const char *username = linphone_address_get_username(address);
+	const char *domain = linphone_address_get_domain(address);
+	if (!domain)
+		return nil;
+	int port = linphone_address_get_port(address);
+	if (!username)
+		return port > 0 ? [[NSString alloc] initWithFormat:@"%s:%d", domain, port]
+						: [[NSString alloc] initWithUTF8String:domain];
+	return port > 0 ? [[NSString alloc] initWithFormat:@"%s@%s:%d", username, domain, port]
+					: [[NSString alloc] initWithFormat:@"%s@%s", username, domain];
+}
+
 + (Contact *)getContactWithAddress:(const LinphoneAddress *)address {
-	Contact *contact = nil;
-	if (address) {
-		char *uri = linphone_address_as_string_uri_only(address);
-		NSString *normalizedSipAddress = [FastAddressBook normalizeSipURI:[NSString stringWithUTF8String:uri]];
-		contact = [FastAddressBook getContact:normalizedSipAddress];
-		ms_free(uri);
-
-		if (!contact) {
-			LinphoneFriend *friend = linphone_core_find_friend(LC, address);
-			MSList *numbers = linphone_friend_get_phone_numbers(friend);
-			while (numbers) {
-				NSString *phone = [NSString stringWithUTF8String:numbers->data];
-				LinphoneProxyConfig *cfg = linphone_core_get_default_proxy_config(LC);
-				
-				if (cfg) {
-					const char *normvalue = linphone_proxy_config_normalize_phone_number(cfg, phone.UTF8String);
-					LinphoneAddress *addr = linphone_proxy_config_normalize_sip_uri(cfg, normvalue);
-					const char *phone_addr = linphone_address_as_string_uri_only(addr);
-					contact = [FastAddressBook getContact:[NSString stringWithUTF8String:phone_addr]];
-				} else {
-					contact = [FastAddressBook getContact:phone];
-				}
-				
-				if (contact) {
-					break;
-				}
-				numbers = numbers->next;
-			}
+	FastAddressBook *addressBook = LinphoneManager.instance.fastAddressBook;
+	if (!address || !addressBook)
+		return nil;
+
+	// no parsing nor serialization: the key is made of the fields of the address
+	NSString *key = indexKeyForAddress(address);
+	if (!key)
+		return nil;
+	NSDictionary<NSString *, Contact *> *index = addressBook.addressIndex;
+	Contact *contact = index[key];
+	if (contact)
+		return contact;
+
+	// misses are the expensive ones: unknown addresses, or friends only known by their phone numbers
+	id resolved = [addressBook->resolvedAddresses objectForKey:key];
+	if (resolved)
+		return resolved == NSNull.null ? nil : resolved;
+
+	LinphoneFriend *friend = linphone_core_find_friend(LC, address);
+	LinphoneProxyConfig *cfg = linphone_core_get_default_proxy_config(LC);
+	bctbx_list_t *numbers = friend ? linphone_friend_get_phone_numbers(friend) : NULL;
+	for (bctbx_list_t *number = numbers; number && !contact; number = number->next) {
+		const char *phone = number->data;
+		if (!cfg) {
+			contact = addressBook.addressBookMap[[NSString stringWithUTF8String:phone]];
+			continue;
+		}
+		char *normalizedPhone = linphone_proxy_config_normalize_phone_number(cfg, phone);
+		LinphoneAddress *phoneAddress = linphone_proxy_config_normalize_sip_uri(cfg, normalizedPhone ?: phone);
+		if (phoneAddress) {
+			NSString *phoneKey = indexKeyForAddress(phoneAddress);
+			if (phoneKey)
+				contact = index[phoneKey];
+			linphone_address_unref(phoneAddress);
 		}
+		if (normalizedPhone)
+			ms_free(normalizedPhone);
 	}
+	bctbx_list_free(numbers);
+
+	// a newer index may have been published meanwhile, this answer must not outlive it
+	if (index == addressBook.addressIndex)
+		[addressBook->resolvedAddresses setObject:contact ?: NSNull.null forKey:key];
 	return contact;
 }
 
@@ -151,9 +223,19 @@
 - (FastAddressBook *)init {
 	if ((self = [super init]) != nil) {
 		store = [[CNContactStore alloc] init];
-		_addressBookMap = [NSMutableDictionary dictionary];
+		_addressBookMap = [NSDictionary dictionary];
+		mapLock = [[NSLock alloc] init];
+		syncQueue = dispatch_queue_create("org.linphone.addressbook", DISPATCH_QUEUE_SERIAL);
+		nativeContacts = [NSMutableDictionary dictionary];
+		fingerprints = [NSMutableDictionary dictionary];
+		contactKeys = [NSMutableDictionary dictionary];
+		friendKeys = [NSMapTable strongToStrongObjectsMapTable];
+		_addressIndex = [NSDictionary dictionary];
+		resolvedAddresses = [[NSCache alloc] init];
+		resolvedAddresses.countLimit = 500;
+		// long enough for a bulk import or deletion to end up in one refresh
+		_subscriptionCoalescer = [[FriendListSubscriptionCoalescer alloc] initWithDelay:0.5];
 	}
-	self.needToUpdate = FALSE;
 	if (floor(NSFoundationVersionNumber) >= NSFoundationVersionNumber_iOS_9_x_Max) {
 		if ([CNContactStore class]) {
 			// ios9 or later
@@ -167,39 +249,14 @@
 }
 
 - (void) fetchContactsInBackGroundThread{
-	[_addressBookMap removeAllObjects];
-	_addressBookMap = [NSMutableDictionary dictionary];
-	CNEntityType entityType = CNEntityTypeContacts;
-	[store requestAccessForEntityType:entityType completionHandler:^(BOOL granted, NSError *_Nullable error) {
-		BOOL success = FALSE;
-		if(granted){
-			LOGD(@"CNContactStore authorization granted");
-			
-			NSError *contactError;
-			CNContactStore* store = [[CNContactStore alloc] init];
-			[store containersMatchingPredicate:[CNContainer predicateForContainersWithIdentifiers:@[ store.defaultContainerIdentifier]] error:&contactError];
-			NSArray *keysToFetch = @[
-									 CNContactEmailAddressesKey, CNContactPhoneNumbersKey,
-									 CNContactFamilyNameKey, CNContactGivenNameKey, CNContactNicknameKey,
-									 CNContactPostalAddressesKey, CNContactIdentifierKey,
-									 CNInstantMessageAddressUsernameKey, CNContactInstantMessageAddressesKey,
-									 CNInstantMessageAddressUsernameKey, CNContactImageDataKey, CNContactOrganizationNameKey
-									 ];
-			CNContactFetchRequest *request = [[CNContactFetchRequest alloc] initWithKeysToFetch:keysToFetch];
-			
-			success = [store enumerateContactsWithFetchRequest:request error:&contactError usingBlock:^(CNContact *__nonnull contact, BOOL *__nonnull stop) {
-				if (contactError) {
-				  NSLog(@"error fetching contacts %@",
-						contactError);
-				} else {
-					Contact *newContact = [[Contact alloc] initWithCNContact:contact];
-					[self registerAddrsFor:newContact];
-				}
-			}];
-		}
+	// the next sync forgets what was loaded and loads every native contact again
+	@synchronized(self) {
+		reloadAll = TRUE;
+	}
+	[self syncContacts];
 
-	}];
 	// load Linphone friends
+	NSMutableArray<Contact *> *friendContacts = [NSMutableArray array];
 	const MSList *lists = linphone_core_get_friends_lists(LC);
 	while (lists) {
 		LinphoneFriendList *fl = lists->data;
@@ -210,13 +267,26 @@
 			// above)
 			if (linphone_friend_get_ref_key(f) == NULL) {
 				Contact *contact = [[Contact alloc] initWithFriend:f];
-				[self registerAddrsFor:contact];
+				if (contact)
+					[friendContacts addObject:contact];
 			}
 			friends = friends->next;
 		}
-		linphone_friend_list_update_subscriptions(fl);
 		lists = lists->next;
 	}
+	[_subscriptionCoalescer friendsChanged:FALSE];
+	// their keys are computed before taking the lock, then published at once
+	NSMapTable<Contact *, ContactKeys *> *newFriendKeys = [NSMapTable strongToStrongObjectsMapTable];
+	NSArray<ContactKeys *> *keys = [self keysForContacts:friendContacts];
+	for (NSUInteger i = 0; i < friendContacts.count; i++)
+		[newFriendKeys setObject:keys[i] forKey:friendContacts[i]];
+	[self updateAddressBookMap:^(NSMutableDictionary *map, NSMutableDictionary *index) {
+	  for (Contact *contact in friendKeys)
+		  unregisterKeys(map, index, [friendKeys objectForKey:contact], contact);
+	  for (Contact *contact in newFriendKeys)
+		  registerKeys(map, index, [newFriendKeys objectForKey:contact], contact);
+	  friendKeys = newFriendKeys;
+	}];
 	[NSNotificationCenter.defaultCenter
 	 postNotificationName:kLinphoneAddressBookUpdate
 	 object:self];
@@ -224,31 +294,346 @@
 
 -(void) updateAddressBook:(NSNotification*) notif {
 	LOGD(@"address book has changed");
-	self.needToUpdate = TRUE;
+	[self syncContacts];
 }
 
-- (void)registerAddrsFor:(Contact *)contact {
-	if (!contact)
+// fields of a contact which matter to us, avatar left aside: a change of one of them means the contact must be reloaded
+static NSArray *contactFingerprint(CNContact *contact) {
+	NSMutableArray *fields = [NSMutableArray arrayWithObjects:contact.givenName ?: @"", contact.familyName ?: @"",
+								  contact.nickname ?: @"", contact.organizationName ?: @"",
+								  @(contact.imageDataAvailable), @(contact.phoneNumbers.count), nil];
+	for (CNLabeledValue<CNPhoneNumber *> *phoneNumber in contact.phoneNumbers)
+		[fields addObject:phoneNumber.value.stringValue ?: @""];
+	[fields addObject:@(contact.instantMessageAddresses.count)];
+	for (CNLabeledValue<CNInstantMessageAddress *> *sipAddr in contact.instantMessageAddresses) {
+		[fields addObject:sipAddr.value.username ?: @""];
+		[fields addObject:sipAddr.value.service ?: @""];
+	}
+	for (CNLabeledValue<NSString *> *email in contact.emailAddresses)
+		[fields addObject:email.value ?: @""];
+	return fields;
+}
+
+- (void)syncContacts {
+	@synchronized(self) {
+		if (syncScheduled)
+			return;
+		syncScheduled = TRUE;
+	}
+	[store requestAccessForEntityType:CNEntityTypeContacts completionHandler:^(BOOL granted, NSError *_Nullable error) {
+		dispatch_async(syncQueue, ^{
+			// changes made from now on need another sync
+			BOOL reload;
+			@synchronized(self) {
+				syncScheduled = FALSE;
+				reload = reloadAll;
+				reloadAll = FALSE;
+			}
+			if (reload) {
+				dispatch_async(dispatch_get_main_queue(), ^{
+					[ContactAvatarCache.sharedCache clear];
+				});
+				[self updateAddressBookMap:^(NSMutableDictionary *map, NSMutableDictionary *index) {
+				  for (NSString *identifier in nativeContacts)
+					  unregisterKeys(map, index, contactKeys[identifier], nativeContacts[identifier]);
+				}];
+				[nativeContacts removeAllObjects];
+				[fingerprints removeAllObjects];
+				[contactKeys removeAllObjects];
+			}
+			if (granted) {
+				LOGD(@"CNContactStore authorization granted");
+				[self syncNativeContacts];
+			}
+		});
+	}];
+}
+
+// must be called on syncQueue
+- (void)syncNativeContacts {
+	CFTimeInterval start = CACurrentMediaTime();
+	NSArray *keysToFetch = @[
+		CNContactEmailAddressesKey, CNContactPhoneNumbersKey,
+		CNContactFamilyNameKey, CNContactGivenNameKey, CNContactNicknameKey,
+		CNContactPostalAddressesKey, CNContactIdentifierKey,
+		CNInstantMessageAddressUsernameKey, CNContactInstantMessageAddressesKey,
+		CNContactImageDataAvailableKey, CNContactOrganizationNameKey
+	];
+	// avatars are fetched when displayed. The first load needs everything else, later ones only compare the fields of
+	// the fingerprint
+	BOOL firstLoad = (fingerprints.count == 0);
+	NSArray *fingerprintKeys = @[
+		CNContactEmailAddressesKey, CNContactPhoneNumbersKey,
+		CNContactFamilyNameKey, CNContactGivenNameKey, CNContactNicknameKey,
+		CNContactIdentifierKey, CNContactInstantMessageAddressesKey,
+		CNContactImageDataAvailableKey, CNContactOrganizationNameKey
+	];
+
+	NSMutableDictionary<NSString *, NSArray *> *currentFingerprints = [NSMutableDictionary dictionary];
+	NSMutableDictionary<NSString *, CNContact *> *changedContacts = [NSMutableDictionary dictionary];
+	NSMutableArray<NSString *> *changedIdentifiers = [NSMutableArray array];
+	NSError *contactError = nil;
+	CNContactFetchRequest *request = [[CNContactFetchRequest alloc] initWithKeysToFetch:firstLoad ? keysToFetch : fingerprintKeys];
+	BOOL success = [store enumerateContactsWithFetchRequest:request error:&contactError usingBlock:^(CNContact *__nonnull contact, BOOL *__nonnull stop) {
+		NSArray *fingerprint = contactFingerprint(contact);
+		currentFingerprints[contact.identifier] = fingerprint;
+		if ([fingerprints[contact.identifier] isEqualToArray:fingerprint])
+			return;
+		if (firstLoad)
+			changedContacts[contact.identifier] = contact;
+		else
+			[changedIdentifiers addObject:contact.identifier];
+	}];
+	if (!success) {
+		LOGE(@"Cannot enumerate contacts: %@", contactError);
 		return;
+	}
+	if (changedIdentifiers.count > 0) {
+		NSArray<CNContact *> *contacts = [store unifiedContactsMatchingPredicate:[CNContact predicateForContactsWithIdentifiers:changedIdentifiers]
+																	 keysToFetch:keysToFetch
+																		   error:&contactError];
+		if (!contacts)
+			LOGE(@"Cannot fetch changed contacts: %@", contactError);
+		for (CNContact *contact in contacts)
+			changedContacts[contact.identifier] = contact;
+	}
 
-	Contact* mContact = contact;
-	if (!_addressBookMap)
+	NSMutableArray<NSString *> *removedIdentifiers = [NSMutableArray array];
+	for (NSString *identifier in fingerprints) {
+		if (!currentFingerprints[identifier])
+			[removedIdentifiers addObject:identifier];
+	}
+
+	// contacts are built outside of the map lock, lookups go on meanwhile
+	NSMutableDictionary<NSString *, Contact *> *newContacts = [NSMutableDictionary dictionary];
+	NSMutableDictionary<NSString *, ContactKeys *> *newKeys = [NSMutableDictionary dictionary];
+	[self buildContacts:changedContacts.allValues contacts:newContacts keys:newKeys];
+
+	__block NSUInteger added = 0, changed = 0;
+	[self updateAddressBookMap:^(NSMutableDictionary *map, NSMutableDictionary *index) {
+	  for (NSString *identifier in removedIdentifiers)
+		  unregisterKeys(map, index, contactKeys[identifier], nativeContacts[identifier]);
+	  for (NSString *identifier in newContacts) {
+		  Contact *previous = nativeContacts[identifier];
+		  if (previous) {
+			  unregisterKeys(map, index, contactKeys[identifier], previous);
+			  changed++;
+		  } else {
+			  added++;
+		  }
+		  registerKeys(map, index, newKeys[identifier], newContacts[identifier]);
+	  }
+	}];
+	for (NSString *identifier in removedIdentifiers) {
+		[nativeContacts removeObjectForKey:identifier];
+		[fingerprints removeObjectForKey:identifier];
+		[contactKeys removeObjectForKey:identifier];
+	}
+	[nativeContacts addEntriesFromDictionary:newContacts];
+	[contactKeys addEntriesFromDictionary:newKeys];
+	for (NSString *identifier in newContacts)
+		fingerprints[identifier] = currentFingerprints[identifier];
+
+	NSUInteger removed = removedIdentifiers.count;
+	LOGI(@"Address book synced in %.0f ms: %lu added, %lu changed, %lu removed, %lu contacts, %lu indexed addresses",
+		 (CACurrentMediaTime() - start) * 1000, (unsigned long)added, (unsigned long)changed, (unsigned long)removed,
+		 (unsigned long)nativeContacts.count, (unsigned long)self.addressIndex.count);
+	if (added + changed + removed == 0)
 		return;
-	
-	LinphoneProxyConfig *cfg = linphone_core_create_proxy_config(LC);
 
-	for (NSString *phone in mContact.phones) {
-		char *normalizedPhone = cfg? linphone_proxy_config_normalize_phone_number(linphone_core_get_default_proxy_config(LC), phone.UTF8String) : nil;
-		NSString *name = [FastAddressBook normalizeSipURI:normalizedPhone ? [NSString stringWithUTF8String:normalizedPhone] : phone];
-		if (phone != NULL)
-			[_addressBookMap setObject:mContact forKey:(name ?: [FastAddressBook localizedLabel:phone])];
+	dispatch_async(dispatch_get_main_queue(), ^{
+		for (NSString *identifier in removedIdentifiers)
+			[ContactAvatarCache.sharedCache removeThumbnailForIdentifier:identifier];
+		for (NSString *identifier in newContacts)
+			[ContactAvatarCache.sharedCache removeThumbnailForIdentifier:identifier];
+		[LinphoneManager.instance setContactsUpdated:TRUE];
+		[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneAddressBookUpdate
+														  object:self
+														userInfo:@{
+															@"added" : @(added),
+															@"changed" : @(changed),
+															@"removed" : @(removed)
+														}];
+	});
+}
 
-		if (normalizedPhone)
-			ms_free(normalizedPhone);
+// same as normalizeSipURI, the address is parsed once for both keys. Returns the lowercased domain, if any
+static NSString *addKeysForAddress(NSString *address, NSMutableArray<NSString *> *mapKeys,
+								   NSMutableArray<NSString *> *indexKeys) {
+	LinphoneAddress *addr = linphone_core_interpret_url(LC, address.UTF8String);
+	if (!addr) {
+		[mapKeys addObject:[FastAddressBook normalizeSipURI:address]];
+		return nil;
 	}
+	linphone_address_clean(addr);
+	char *tmp = linphone_address_as_string(addr);
+	[mapKeys addObject:[NSString stringWithUTF8String:tmp]];
+	ms_free(tmp);
+	NSString *key = indexKeyForAddress(addr);
+	if (key)
+		[indexKeys addObject:key];
+	const char *domain = linphone_address_get_domain(addr);
+	NSString *lowercaseDomain = domain ? [NSString stringWithUTF8String:domain].lowercaseString : nil;
+	linphone_address_unref(addr);
+	return lowercaseDomain;
+}
 
-	for (NSString *sip in mContact.sipAddresses)
-		[_addressBookMap setObject:mContact forKey:([FastAddressBook normalizeSipURI:sip] ?: sip)];
+// keys under which the contact is found in addressBookMap and in the address index
+- (ContactKeys *)keysForContact:(Contact *)contact {
+	return [self keysForContacts:@[ contact ]].firstObject;
+}
+
+// number of contacts built in a row on the main thread during a sync
+#define CONTACTS_CHUNK_SIZE 200
+
+// A contact creates its friend in the core and its addresses are normalized through it, and liblinphone is only used
+// from the main thread: the sync queue hands the contacts over to it by chunks, so that the main thread keeps
+// processing events between them. Must be called on syncQueue
+- (void)buildContacts:(NSArray<CNContact *> *)cncontacts
+			 contacts:(NSMutableDictionary<NSString *, Contact *> *)contacts
+				 keys:(NSMutableDictionary<NSString *, ContactKeys *> *)keys {
+	for (NSUInteger i = 0; i < cncontacts.count; i += CONTACTS_CHUNK_SIZE) {
+		NSArray<CNContact *> *chunk =
+			[cncontacts subarrayWithRange:NSMakeRange(i, MIN(CONTACTS_CHUNK_SIZE, cncontacts.count - i))];
+		dispatch_sync(dispatch_get_main_queue(), ^{
+		  NSMutableArray<NSString *> *identifiers = [NSMutableArray arrayWithCapacity:chunk.count];
+		  NSMutableArray<Contact *> *built = [NSMutableArray arrayWithCapacity:chunk.count];
+		  for (CNContact *cncontact in chunk) {
+			  Contact *contact = [[Contact alloc] initWithCNContact:cncontact];
+			  if (!contact)
+				  continue;
+			  [identifiers addObject:cncontact.identifier];
+			  [built addObject:contact];
+		  }
+		  NSArray<ContactKeys *> *builtKeys = [self keysForContacts:built];
+		  for (NSUInteger j = 0; j < built.count; j++) {
+			  contacts[identifiers[j]] = built[j];
+			  keys[identifiers[j]] = builtKeys[j];
+		  }
+		});
+	}
+}
+
+// keys of each contact, in the same order. Numbers and addresses shared by several contacts are only normalized once.
+// Must be called on the main thread
+- (NSArray<ContactKeys *> *)keysForContacts:(NSArray<Contact *> *)contacts {
+	CFTimeInterval start = CACurrentMediaTime();
+	// one dial plan for the whole batch: the default account's, or the one of a new account when there is none
+	LinphoneProxyConfig *tmpCfg = NULL;
+	LinphoneProxyConfig *cfg = linphone_core_get_default_proxy_config(LC);
+	if (!cfg)
+		cfg = tmpCfg = linphone_core_create_proxy_config(LC);
+
+	// phone numbers and SIP addresses are not normalized the same way, hence separate caches
+	NSMutableDictionary<NSString *, ContactKeys *> *phoneKeys = [NSMutableDictionary dictionary];
+	NSMutableDictionary<NSString *, ContactKeys *> *sipKeys = [NSMutableDictionary dictionary];
+	// SIP address -> its domain or NSNull, kept with the contact for the domain filter
+	NSMutableDictionary<NSString *, id> *sipDomains = [NSMutableDictionary dictionary];
+	NSMutableArray<ContactKeys *> *result = [NSMutableArray arrayWithCapacity:contacts.count];
+	NSUInteger count = 0;
+
+	for (Contact *contact in contacts) {
+		NSMutableArray<NSString *> *mapKeys = [NSMutableArray array];
+		NSMutableArray<NSString *> *indexKeys = [NSMutableArray array];
+
+		for (NSString *phone in contact.phones) {
+			ContactKeys *keys = phoneKeys[phone];
+			if (!keys) {
+				keys = [[ContactKeys alloc] init];
+				NSMutableArray<NSString *> *phoneMapKeys = [NSMutableArray arrayWithCapacity:1];
+				NSMutableArray<NSString *> *phoneIndexKeys = [NSMutableArray arrayWithCapacity:1];
+				char *normalizedPhone = linphone_proxy_config_normalize_phone_number(cfg, phone.UTF8String);
+				addKeysForAddress(normalizedPhone ? [NSString stringWithUTF8String:normalizedPhone] : phone, phoneMapKeys,
+								  phoneIndexKeys);
+				if (normalizedPhone)
+					ms_free(normalizedPhone);
+				keys.mapKeys = phoneMapKeys;
+				keys.indexKeys = phoneIndexKeys;
+				phoneKeys[phone] = keys;
+			}
+			[mapKeys addObjectsFromArray:keys.mapKeys];
+			[indexKeys addObjectsFromArray:keys.indexKeys];
+			count++;
+		}
+
+		NSMutableSet<NSString *> *domains = [NSMutableSet set];
+		for (NSString *sip in contact.sipAddresses) {
+			ContactKeys *keys = sipKeys[sip];
+			if (!keys) {
+				keys = [[ContactKeys alloc] init];
+				NSMutableArray<NSString *> *sipMapKeys = [NSMutableArray arrayWithCapacity:1];
+				NSMutableArray<NSString *> *sipIndexKeys = [NSMutableArray arrayWithCapacity:1];
+				sipDomains[sip] = addKeysForAddress(sip, sipMapKeys, sipIndexKeys) ?: NSNull.null;
+				keys.mapKeys = sipMapKeys;
+				keys.indexKeys = sipIndexKeys;
+				sipKeys[sip] = keys;
+			}
+			if (sipDomains[sip] != NSNull.null)
+				[domains addObject:sipDomains[sip]];
+			[mapKeys addObjectsFromArray:keys.mapKeys];
+			[indexKeys addObjectsFromArray:keys.indexKeys];
+			count++;
+		}
+		[contact setSipDomains:domains];
+
+		ContactKeys *keys = [[ContactKeys alloc] init];
+		keys.mapKeys = mapKeys;
+		keys.indexKeys = indexKeys;
+		[result addObject:keys];
+	}
+
+	if (tmpCfg)
+		linphone_proxy_config_unref(tmpCfg);
+
+	// a single contact is saved or edited, only loads are worth reporting
+	if (contacts.count > 1) {
+		CFTimeInterval elapsed = CACurrentMediaTime() - start;
+		LOGI(@"Normalized %lu addresses (%lu distinct) of %lu contacts in %.1f ms, %.1f us per address",
+			 (unsigned long)count, (unsigned long)(phoneKeys.count + sipKeys.count), (unsigned long)contacts.count,
+			 elapsed * 1000, count > 0 ? elapsed * 1000000 / count : 0);
+	}
+	return result;
+}
+
+static void registerKeys(NSMutableDictionary *map, NSMutableDictionary *index, ContactKeys *keys, Contact *contact) {
+	for (NSString *key in keys.mapKeys)
+		[map setObject:contact forKey:key];
+	for (NSString *key in keys.indexKeys)
+		[index setObject:contact forKey:key];
+}
+
+// keys since taken by another contact are left alone
+static void unregisterKeys(NSMutableDictionary *map, NSMutableDictionary *index, ContactKeys *keys, Contact *contact) {
+	for (NSString *key in keys.mapKeys) {
+		if ([map objectForKey:key] == contact)
+			[map removeObjectForKey:key];
+	}
+	for (NSString *key in keys.indexKeys) {
+		if ([index objectForKey:key] == contact)
+			[index removeObjectForKey:key];
+	}
+}
+
+// writers change a copy of the current snapshots, then publish them
+- (void)updateAddressBookMap:(void (^)(NSMutableDictionary *map, NSMutableDictionary *index))block {
+	[mapLock lock];
+	NSMutableDictionary *map = [self.addressBookMap mutableCopy];
+	NSMutableDictionary *index = [self.addressIndex mutableCopy];
+	block(map, index);
+	self.addressBookMap = [map copy];
+	self.addressIndex = [index copy];
+	[resolvedAddresses removeAllObjects];
+	[mapLock unlock];
+}
+
+- (void)registerAddrsFor:(Contact *)contact {
+	if (!contact)
+		return;
+
+	ContactKeys *keys = [self keysForContact:contact];
+	[self updateAddressBookMap:^(NSMutableDictionary *map, NSMutableDictionary *index) {
+	  registerKeys(map, index, keys, contact);
+	}];
 }
 
 #pragma mark - Tools
@@ -260,49 +645,44 @@
 	return @"";
 }
 
+static BOOL domainMatchesFilter(NSString *domain, NSString *filter) {
+	return [filter isEqualToString:@"*"] || [domain isEqualToString:filter];
+}
+
 + (BOOL)contactHasValidSipDomain:(Contact *)contact {
 	if (!contact)
 		return NO;
 	
-	// Check if one of the contact' sip URI matches the expected SIP filter
-	NSString *domain = LinphoneManager.instance.contactFilter;
-
-	for (NSString *sip in contact.sipAddresses) {
-		// check domain
-		LinphoneAddress *address = linphone_core_interpret_url(LC, sip.UTF8String);
-		if (address) {
-			const char *dom = linphone_address_get_domain(address);
-			BOOL match = false;
-			if (dom != NULL) {
-				NSString *contactDomain = [NSString stringWithCString:dom encoding:[NSString defaultCStringEncoding]];
-				match = (([domain compare:@"*" options:NSCaseInsensitiveSearch] == NSOrderedSame) ||
-						 ([domain compare:contactDomain options:NSCaseInsensitiveSearch] == NSOrderedSame));
-			}
-			linphone_address_destroy(address);
-			if (match)
-				return YES;
-		}
-	}
-	return NO;
+	// Check if one of the contact' sip URI matches the expected SIP filter. Domains are parsed once per contact, a
+	// filter change only changes the comparison
+	NSString *filter = LinphoneManager.instance.contactFilter.lowercaseString;
+	NSSet<NSString *> *domains = contact.sipDomains;
+	if ([filter isEqualToString:@"*"])
+		return domains.count > 0;
+	return filter && [domains containsObject:filter];
 }
 
 + (BOOL) isSipURIValid:(NSString*)addr {
-	NSString *domain = LinphoneManager.instance.contactFilter;
-	LinphoneAddress* address = linphone_core_interpret_url(LC, addr.UTF8String);
-	if (address) {
-		const char *dom = linphone_address_get_domain(address);
-		BOOL match = false;
-		if (dom != NULL) {
-			NSString *contactDomain = [NSString stringWithCString:dom encoding:[NSString defaultCStringEncoding]];
-			match = (([domain compare:@"*" options:NSCaseInsensitiveSearch] == NSOrderedSame) ||
-					 ([domain compare:contactDomain options:NSCaseInsensitiveSearch] == NSOrderedSame));
-		}
-		linphone_address_destroy(address);
-		if (match) {
-			return YES;
-		}
+	// SIP address -> lowercased domain or NSNull, the contact details cells ask for the same addresses over and over
+	static NSCache<NSString *, id> *domains;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+	  domains = [[NSCache alloc] init];
+	  domains.countLimit = 200;
+	});
+	if (!addr)
+		return NO;
+
+	id domain = [domains objectForKey:addr];
+	if (!domain) {
+		LinphoneAddress *address = linphone_core_interpret_url(LC, addr.UTF8String);
+		const char *dom = address ? linphone_address_get_domain(address) : NULL;
+		domain = dom ? [NSString stringWithUTF8String:dom].lowercaseString : NSNull.null;
+		if (address)
+			linphone_address_unref(address);
+		[domains setObject:domain forKey:addr];
 	}
-	return NO;
+	return domain != NSNull.null && domainMatchesFilter(domain, LinphoneManager.instance.contactFilter.lowercaseString);
 }
 
 + (NSString *)displayNameForContact:(Contact *)contact {
@@ -330,6 +710,16 @@
 }
 
 
+- (NSData *)imageDataForIdentifier:(NSString *)identifier {
+	if (!identifier)
+		return nil;
+	NSError *error = nil;
+	CNContact *contact = [store unifiedContactWithIdentifier:identifier keysToFetch:@[ CNContactImageDataKey ] error:&error];
+	if (!contact)
+		LOGW(@"Cannot fetch avatar of contact %@: %@", identifier, error);
+	return contact.imageData;
+}
+
 - (CNContact *)getCNContactFromContact:(Contact *)acontact {
   NSArray *keysToFetch = @[
     CNContactEmailAddressesKey, CNContactPhoneNumbersKey,
@@ -365,16 +755,10 @@
 		@try {
 			[self removeFriend:contact ];
 			[LinphoneManager.instance setContactsUpdated:TRUE];
-			if([contact.sipAddresses count] > 0){
-				for (NSString *sip in contact.sipAddresses) {
-					[_addressBookMap removeObjectForKey:([FastAddressBook normalizeSipURI:sip] ?: sip)];
-				}
-			}
-			if([contact.phones count] > 0){
-				for (NSString *phone in contact.phones) {
-					[_addressBookMap removeObjectForKey:([FastAddressBook normalizeSipURI:phone] ?: phone)];
-				}
-			}
+			ContactKeys *keys = [self keysForContact:contact];
+			[self updateAddressBookMap:^(NSMutableDictionary *map, NSMutableDictionary *index) {
+			  unregisterKeys(map, index, keys, contact);
+			}];
 			BOOL success = [store executeSaveRequest:saveRequest error:nil];
 			NSLog(@"Success %d", success);
 		} @catch (NSException *exception) {
@@ -452,7 +836,8 @@
 	  NSLog(@"=====>>>>> CNContact SaveRequest failed : description = %@", [exception description]);
 	  return FALSE;
   }
-	[self fetchContactsInBackGroundThread];
+	// only the contacts which changed are reloaded
+	[self syncContacts];
   return TRUE;
 }
 
@@ -466,26 +851,16 @@
 			linphone_friend_done(contact.friend);
 		}
 	}
-	
-	BOOL enabled = [LinphoneManager.instance lpConfigBoolForKey:@"use_rls_presence"];
-	const MSList *lists = linphone_core_get_friends_lists(LC);
-	while (lists) {
-		linphone_friend_list_enable_subscriptions(lists->data, FALSE);
-		linphone_friend_list_enable_subscriptions(lists->data, enabled);
-		linphone_friend_list_update_subscriptions(lists->data);
-		lists = lists->next;
-	}
+	bctbx_list_free(phonesList);
+	[_subscriptionCoalescer friendsChanged:TRUE];
 }
 
 -(void)removeFriend:(Contact*) contact{
-	BOOL enabled = [LinphoneManager.instance lpConfigBoolForKey:@"use_rls_presence"];
 	const MSList *lists = linphone_core_get_friends_lists(LC);
 	while (lists) {
 		linphone_friend_list_remove_friend(lists->data, contact.friend);
-		linphone_friend_list_enable_subscriptions(lists->data, FALSE);
-		linphone_friend_list_enable_subscriptions(lists->data, enabled);
-		linphone_friend_list_update_subscriptions(lists->data);
 		lists = lists->next;
 	}
+	[_subscriptionCoalescer friendsChanged:TRUE];
 }
 @end
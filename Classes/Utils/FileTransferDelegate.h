@@ -21,15 +21,27 @@
 
 #import "LinphoneManager.h"
 
+@class FileTransferDelegate;
+
+/* Progress of a transfer, throttled and delivered on the main thread to the view bound to it */
+@protocol FileTransferProgressDelegate <NSObject>
+- (void)fileTransfer:(FileTransferDelegate *)ftd didUpdateProgress:(float)progress;
+@end
+
 @interface FileTransferDelegate : NSObject
 
 - (void)upload:(UIImage *)image withassetId:(NSString *)phAssetId forChatRoom:(LinphoneChatRoom *)chatRoom withQuality:(float)quality;
 - (void)uploadFile:(NSData *)data forChatRoom:(LinphoneChatRoom *)chatRoom withName:(NSString *)name;
 - (void)uploadVideo:(NSData *)data withassetId:(NSString *)phAssetId forChatRoom:(LinphoneChatRoom *)chatRoom;
 - (void)cancel;
+/* queued by the file transfer scheduler, FALSE if the message has nothing to download */
 - (BOOL)download:(LinphoneChatMessage *)message;
+- (BOOL)download:(LinphoneChatMessage *)message priority:(FileTransferPriority)priority;
+/* called by the file transfer scheduler when the transfer may begin */
+- (void)start;
 - (void)stopAndDestroy;
 
 @property() LinphoneChatMessage *message;
 @property() NSString *text;
+@property(weak) id<FileTransferProgressDelegate> progressDelegate;
 @end
@@ -22,8 +22,30 @@
 #import "PhoneMainView.h"
 #import "Utils.h"
 
+#import <ImageIO/ImageIO.h>
+#import <QuartzCore/QuartzCore.h>
+
+// progress is reported when it advanced by at least STEP, at most every INTERVAL seconds
+#define FILE_TRANSFER_PROGRESS_STEP 0.01f
+#define FILE_TRANSFER_PROGRESS_INTERVAL 0.1
+
 @interface FileTransferDelegate ()
-@property(strong) NSMutableData *data;
+// content being uploaded, memory mapped when it comes from a file
+@property(strong) NSData *data;
+// incoming files are written to this temporary file as they are received
+@property(strong) NSString *downloadPath;
+@property(strong) NSFileHandle *downloadHandle;
+@property unsigned long long receivedSize;
+@property float reportedProgress;
+@property CFTimeInterval reportTime;
+// the scheduler let the transfer begin
+@property BOOL started;
+
+- (void)openDownloadFile;
+- (void)appendDownloadBytes:(const uint8_t *)bytes length:(size_t)length;
+- (void)closeDownloadFile;
+- (void)reportProgress:(float)progress;
+- (void)unregister;
 @end
 
 @implementation FileTransferDelegate
@@ -35,12 +57,7 @@
 }
 
 + (FileTransferDelegate *)messageDelegate:(LinphoneChatMessage *)message {
-	for (FileTransferDelegate *ftd in [LinphoneManager.instance fileTransferDelegates]) {
-		if (ftd.message == message) {
-			return ftd;
-		}
-	}
-	return nil;
+	return [LinphoneManager.instance.fileTransferRegistry delegateForMessage:message];
 }
 
 static void linphone_iphone_file_transfer_recv(LinphoneChatMessage *message, const LinphoneContent *content,
@@ -48,175 +65,184 @@ static void linphone_iphone_file_transfer_recv(LinphoneChatMessage *message, con
 	FileTransferDelegate *thiz = [FileTransferDelegate messageDelegate:message];
 	size_t size = linphone_buffer_get_size(buffer);
 
-	if (!thiz.data) {
-		thiz.data = [[NSMutableData alloc] initWithCapacity:linphone_content_get_file_size(content)];
+	if (!thiz.downloadPath) {
+		[thiz openDownloadFile];
 	}
 
 	if (size == 0) {
 		LOGI(@"Transfer of %s (%d bytes): download finished", linphone_content_get_name(content), size);
-		assert([thiz.data length] == linphone_content_get_file_size(content));
-        NSString *fileType = [NSString stringWithUTF8String:linphone_content_get_type(content)];
-        ChatConversationView *view = VIEW(ChatConversationView);
-        void (^block)(void)= ^ {
-            if ([fileType isEqualToString:@"image"]) {
-                // we're finished, save the image and update the message
-                UIImage *image = [UIImage imageWithData:thiz.data];
-                if (!image) {
+		[thiz closeDownloadFile];
+		size_t expectedSize = linphone_content_get_file_size(content);
+		BOOL complete = (expectedSize == 0 || thiz.receivedSize == expectedSize);
+		if (!complete)
+			LOGE(@"Transfer of %s: received %llu bytes instead of %zu", linphone_content_get_name(content),
+				 thiz.receivedSize, expectedSize);
+		NSString *fileType = [NSString stringWithUTF8String:linphone_content_get_type(content)];
+		NSString *name = [NSString stringWithUTF8String:linphone_content_get_name(content)];
+		ChatConversationView *view = VIEW(ChatConversationView);
+		if (!complete) {
+			[view showFileDownloadError];
+			[thiz stopAndDestroy];
+			return;
+		}
+		NSURL *downloadURL = [NSURL fileURLWithPath:thiz.downloadPath];
+		void (^block)(void)= ^ {
+			if ([fileType isEqualToString:@"image"]) {
+				// we're finished, save the image and update the message. Only check that the file is an image,
+				// the photo library imports it from the file without us decoding it
+				CGImageSourceRef source = CGImageSourceCreateWithURL((__bridge CFURLRef)downloadURL, NULL);
+				BOOL isImage = source && CGImageSourceGetCount(source) > 0;
+				if (source)
+					CFRelease(source);
+				if (!isImage) {
 					[view showFileDownloadError];
-                    [thiz stopAndDestroy];
-                    return;
-                }
-                
-                CFBridgingRetain(thiz);
-                [[LinphoneManager.instance fileTransferDelegates] removeObject:thiz];
-                
-                // until image is properly saved, keep a reminder on it so that the
-                // chat bubble is aware of the fact that image is being saved to device
-                [LinphoneManager setValueInMessageAppData:@"saving..." forKey:@"localimage" inMessage:message];
-                __block PHObjectPlaceholder *placeHolder;
-                [[PHPhotoLibrary sharedPhotoLibrary] performChanges:^{
-                    PHAssetCreationRequest *request = [PHAssetCreationRequest creationRequestForAssetFromImage:image];
-                    placeHolder = [request placeholderForCreatedAsset];
-                } completionHandler:^(BOOL success, NSError *error) {
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        if (error) {
-                            LOGE(@"Cannot save image data downloaded [%@]", [error localizedDescription]);
-                            [LinphoneManager setValueInMessageAppData:nil forKey:@"localimage" inMessage:message];
-                            UIAlertController *errView = [UIAlertController alertControllerWithTitle:NSLocalizedString(@"Transfer error", nil)
-                                                                                             message:NSLocalizedString(@"Cannot write image to photo library",
-                                                                                                                       nil)
-                                                                                      preferredStyle:UIAlertControllerStyleAlert];
-                            
-                            UIAlertAction* defaultAction = [UIAlertAction actionWithTitle:@"OK"
-                                                                                    style:UIAlertActionStyleDefault
-                                                                                  handler:^(UIAlertAction * action) {}];
-                            
-                            [errView addAction:defaultAction];
-                            [PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
-                        } else {
-                            LOGI(@"Image saved to [%@]", [placeHolder localIdentifier]);
-                            [LinphoneManager setValueInMessageAppData:[placeHolder localIdentifier]
-                                                               forKey:@"localimage"
-                                                            inMessage:message];
-                        }
-                        [NSNotificationCenter.defaultCenter
-                         postNotificationName:kLinphoneFileTransferRecvUpdate
-                         object:thiz
-                         userInfo:@{
-                                    @"state" : @(LinphoneChatMessageStateDelivered), // we dont want to
-                                    // trigger
-                                    // FileTransferDone here
-                                    @"image" : image,
-                                    @"progress" : @(1.f),
-                                    }];
-                        
-                        [thiz stopAndDestroy];
-                        CFRelease((__bridge CFTypeRef)thiz);
-                    });
-                }];
-            }  else if([fileType isEqualToString:@"video"]) {
-                CFBridgingRetain(thiz);
-                [[LinphoneManager.instance fileTransferDelegates] removeObject:thiz];
-                NSString *name =[NSString stringWithUTF8String:linphone_content_get_name(content)];
-                NSString *filePath = [[LinphoneManager cacheDirectory] stringByAppendingPathComponent:name];
-                [[NSFileManager defaultManager] createFileAtPath:filePath
-                                                        contents:thiz.data
-                                                      attributes:nil];
-                // until image is properly saved, keep a reminder on it so that the
-                // chat bubble is aware of the fact that image is being saved to device
-                [LinphoneManager setValueInMessageAppData:@"saving..." forKey:@"localvideo" inMessage:message];
-                
-                __block PHObjectPlaceholder *placeHolder;
-                [[PHPhotoLibrary sharedPhotoLibrary] performChanges:^{
-                    PHAssetCreationRequest *request = [PHAssetCreationRequest creationRequestForAssetFromVideoAtFileURL:[NSURL fileURLWithPath:filePath]];
-                    placeHolder = [request placeholderForCreatedAsset];
-                } completionHandler:^(BOOL success, NSError * _Nullable error) {
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        if (error) {
-                            LOGE(@"Cannot save video data downloaded [%@]", [error localizedDescription]);
-                            [LinphoneManager setValueInMessageAppData:nil forKey:@"localvideo" inMessage:message];
-                            UIAlertController *errView = [UIAlertController alertControllerWithTitle:NSLocalizedString(@"Transfer error", nil)
-                                                                                             message:NSLocalizedString(@"Cannot write video to photo library",
-                                                                                                                       nil)
-                                                                                      preferredStyle:UIAlertControllerStyleAlert];
-                            
-                            UIAlertAction* defaultAction = [UIAlertAction actionWithTitle:@"OK"
-                                                                                    style:UIAlertActionStyleDefault
-                                                                                  handler:^(UIAlertAction * action) {}];
-                            
-                            [errView addAction:defaultAction];
-                            [PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
-                        } else {
-                            LOGI(@"video saved to [%@]", [placeHolder localIdentifier]);
-                            [LinphoneManager setValueInMessageAppData:[placeHolder localIdentifier]
-                                                               forKey:@"localvideo"
-                                                            inMessage:message];
-                        }
-                        [NSNotificationCenter.defaultCenter
-                         postNotificationName:kLinphoneFileTransferRecvUpdate
-                         object:thiz
-                         userInfo:@{
-                                    @"state" : @(LinphoneChatMessageStateDelivered), // we dont want to
-                                    // trigger
-                                    // FileTransferDone here
-                                    @"progress" : @(1.f),
-                                    }];
-                        
-                        [thiz stopAndDestroy];
-                        CFRelease((__bridge CFTypeRef)thiz);
-                    });
-                }];
-            }
-        };
-        // When you save an image or video to a photo library, make sure that it is allowed. Otherwise, there will be a backup error.
-        if ([fileType isEqualToString:@"image"] || [fileType isEqualToString:@"video"]) {
-            if ([PHPhotoLibrary authorizationStatus] == PHAuthorizationStatusAuthorized) {
-                block();
-            } else {
-                [PHPhotoLibrary requestAuthorization:^(PHAuthorizationStatus status) {
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        if ([PHPhotoLibrary authorizationStatus] == PHAuthorizationStatusAuthorized) {
-                            block();
-                        } else {
-                            [[[UIAlertView alloc] initWithTitle:NSLocalizedString(@"Photo's permission", nil) message:NSLocalizedString(@"Photo not authorized", nil) delegate:nil cancelButtonTitle:nil otherButtonTitles:@"Continue", nil] show];
-                            [thiz stopAndDestroy];
-                        }
-                    });
-                }];
-            }
-        } else {
-            [[LinphoneManager.instance fileTransferDelegates] removeObject:thiz];
-            NSString *key =  @"localfile" ;
-            NSString *name =[NSString stringWithUTF8String:linphone_content_get_name(content)];
-            [LinphoneManager setValueInMessageAppData:@"saving..." forKey:key inMessage:message];
-           
-            //write file to path
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if([view writeFileInICloud:thiz.data fileURL:[view getICloudFileUrl:name]]) {
-                    [LinphoneManager setValueInMessageAppData:name forKey:key inMessage:message];
-                    
-                    [NSNotificationCenter.defaultCenter
-                     postNotificationName:kLinphoneFileTransferRecvUpdate
-                     object:thiz
-                     userInfo:@{
-                                @"state" : @(LinphoneChatMessageStateDelivered), // we dont want to trigger
-                                @"progress" : @(1.f),    // FileTransferDone here
-                                }];
-                }
-                [thiz stopAndDestroy];
-            });
-        }
-    } else {
-		LOGD(@"Transfer of %s (%d bytes): already %ld sent, adding %ld", linphone_content_get_name(content),
-			 linphone_content_get_file_size(content), [thiz.data length], size);
-		[thiz.data appendBytes:linphone_buffer_get_string_content(buffer) length:size];
-		[NSNotificationCenter.defaultCenter
-			postNotificationName:kLinphoneFileTransferRecvUpdate
-						  object:thiz
+					[thiz stopAndDestroy];
+					return;
+				}
+
+				CFBridgingRetain(thiz);
+				[thiz unregister];
+
+				// until image is properly saved, keep a reminder on it so that the
+				// chat bubble is aware of the fact that image is being saved to device
+				[LinphoneManager setValueInMessageAppData:@"saving..." forKey:@"localimage" inMessage:message];
+				__block PHObjectPlaceholder *placeHolder;
+				[[PHPhotoLibrary sharedPhotoLibrary] performChanges:^{
+					PHAssetCreationRequest *request = [PHAssetCreationRequest creationRequestForAssetFromImageAtFileURL:downloadURL];
+					placeHolder = [request placeholderForCreatedAsset];
+				} completionHandler:^(BOOL success, NSError *error) {
+					dispatch_async(dispatch_get_main_queue(), ^{
+						if (error) {
+							LOGE(@"Cannot save image data downloaded [%@]", [error localizedDescription]);
+							[LinphoneManager setValueInMessageAppData:nil forKey:@"localimage" inMessage:message];
+							UIAlertController *errView = [UIAlertController alertControllerWithTitle:NSLocalizedString(@"Transfer error", nil)
+																							message:NSLocalizedString(@"Cannot write image to photo library",
+																													nil)
+																					preferredStyle:UIAlertControllerStyleAlert];
+
+							UIAlertAction* defaultAction = [UIAlertAction actionWithTitle:@"OK"
+																					style:UIAlertActionStyleDefault
+																				handler:^(UIAlertAction * action) {}];
+
+							[errView addAction:defaultAction];
+							[PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
+						} else {
+							LOGI(@"Image saved to [%@]", [placeHolder localIdentifier]);
+							[LinphoneManager setValueInMessageAppData:[placeHolder localIdentifier]
+															forKey:@"localimage"
+															inMessage:message];
+						}
+						[NSNotificationCenter.defaultCenter
+						postNotificationName:kLinphoneFileTransferRecvUpdate
+						object:thiz
 						userInfo:@{
-							@"state" : @(linphone_chat_message_get_state(message)),
-							@"progress" : @([thiz.data length] * 1.f / linphone_content_get_file_size(content)),
-						}];
+									@"state" : @(LinphoneChatMessageStateDelivered), // we dont want to
+									// trigger
+									// FileTransferDone here
+									@"progress" : @(1.f),
+									}];
+
+						[thiz stopAndDestroy];
+						CFRelease((__bridge CFTypeRef)thiz);
+					});
+				}];
+			}  else if([fileType isEqualToString:@"video"]) {
+				CFBridgingRetain(thiz);
+				[thiz unregister];
+				NSString *filePath = [[LinphoneManager cacheDirectory] stringByAppendingPathComponent:name];
+				NSError *moveError = nil;
+				[[NSFileManager defaultManager] removeItemAtPath:filePath error:nil];
+				if ([[NSFileManager defaultManager] moveItemAtPath:thiz.downloadPath toPath:filePath error:&moveError])
+					thiz.downloadPath = nil;
+				else
+					LOGE(@"Cannot move downloaded video to [%@]: %@", filePath, moveError.localizedDescription);
+				// until image is properly saved, keep a reminder on it so that the
+				// chat bubble is aware of the fact that image is being saved to device
+				[LinphoneManager setValueInMessageAppData:@"saving..." forKey:@"localvideo" inMessage:message];
+
+				__block PHObjectPlaceholder *placeHolder;
+				[[PHPhotoLibrary sharedPhotoLibrary] performChanges:^{
+					PHAssetCreationRequest *request = [PHAssetCreationRequest creationRequestForAssetFromVideoAtFileURL:[NSURL fileURLWithPath:filePath]];
+					placeHolder = [request placeholderForCreatedAsset];
+				} completionHandler:^(BOOL success, NSError * _Nullable error) {
+					dispatch_async(dispatch_get_main_queue(), ^{
+						if (error) {
+							LOGE(@"Cannot save video data downloaded [%@]", [error localizedDescription]);
+							[LinphoneManager setValueInMessageAppData:nil forKey:@"localvideo" inMessage:message];
+							UIAlertController *errView = [UIAlertController alertControllerWithTitle:NSLocalizedString(@"Transfer error", nil)
+																							message:NSLocalizedString(@"Cannot write video to photo library",
+																													nil)
+																					preferredStyle:UIAlertControllerStyleAlert];
+
+							UIAlertAction* defaultAction = [UIAlertAction actionWithTitle:@"OK"
+																					style:UIAlertActionStyleDefault
+																				handler:^(UIAlertAction * action) {}];
+
+							[errView addAction:defaultAction];
+							[PhoneMainView.instance presentViewController:errView animated:YES completion:nil];
+						} else {
+							LOGI(@"video saved to [%@]", [placeHolder localIdentifier]);
+							[LinphoneManager setValueInMessageAppData:[placeHolder localIdentifier]
+															forKey:@"localvideo"
+															inMessage:message];
+						}
+						[NSNotificationCenter.defaultCenter
+						postNotificationName:kLinphoneFileTransferRecvUpdate
+						object:thiz
+						userInfo:@{
+									@"state" : @(LinphoneChatMessageStateDelivered), // we dont want to
+									// trigger
+									// FileTransferDone here
+									@"progress" : @(1.f),
+									}];
+
+						[thiz stopAndDestroy];
+						CFRelease((__bridge CFTypeRef)thiz);
+					});
+				}];
+			}
+		};
+		// When you save an image or video to a photo library, make sure that it is allowed. Otherwise, there will be a backup error.
+		if ([fileType isEqualToString:@"image"] || [fileType isEqualToString:@"video"]) {
+			if ([PHPhotoLibrary authorizationStatus] == PHAuthorizationStatusAuthorized) {
+				block();
+			} else {
+				[PHPhotoLibrary requestAuthorization:^(PHAuthorizationStatus status) {
+					dispatch_async(dispatch_get_main_queue(), ^{
+						if ([PHPhotoLibrary authorizationStatus] == PHAuthorizationStatusAuthorized) {
+							block();
+						} else {
+							[[[UIAlertView alloc] initWithTitle:NSLocalizedString(@"Photo's permission", nil) message:NSLocalizedString(@"Photo not authorized", nil) delegate:nil cancelButtonTitle:nil otherButtonTitles:@"Continue", nil] show];
+							[thiz stopAndDestroy];
+						}
+					});
+				}];
+			}
+		} else {
+			[thiz unregister];
+			NSString *key =  @"localfile" ;
+			[LinphoneManager setValueInMessageAppData:@"saving..." forKey:key inMessage:message];
+
+			//write file to path
+			dispatch_async(dispatch_get_main_queue(), ^{
+				if([view moveFileInICloud:downloadURL fileURL:[view getICloudFileUrl:name]]) {
+					thiz.downloadPath = nil;
+					[LinphoneManager setValueInMessageAppData:name forKey:key inMessage:message];
+
+					[NSNotificationCenter.defaultCenter
+					postNotificationName:kLinphoneFileTransferRecvUpdate
+					object:thiz
+					userInfo:@{
+								@"state" : @(LinphoneChatMessageStateDelivered), // we dont want to trigger
+								@"progress" : @(1.f),    // FileTransferDone here
+								}];
+				}
+				[thiz stopAndDestroy];
+			});
+		}
+    } else {
+		[thiz appendDownloadBytes:linphone_buffer_get_content(buffer) length:size];
+		[thiz reportProgress:thiz.receivedSize * 1.f / linphone_content_get_file_size(content)];
 	}
     
 }
@@ -228,22 +254,12 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
 	if (thiz.data) {
 		size_t remaining = total - offset;
 
-		NSMutableDictionary *dict = [NSMutableDictionary dictionaryWithDictionary:@{
-			@"state" : @(linphone_chat_message_get_state(message)),
-			@"progress" : @(offset * 1.f / total),
-		}];
-		LOGD(@"Transfer of %s (%d bytes): already sent %ld (%f%%), remaining %ld", linphone_content_get_name(content),
-			 total, offset, offset * 100.f / total, remaining);
-		[NSNotificationCenter.defaultCenter postNotificationName:kLinphoneFileTransferSendUpdate
-														  object:thiz
-														userInfo:dict];
+		[thiz reportProgress:offset * 1.f / total];
 
+		// the chunk is copied once, straight from our data into the buffer handed to the core
 		LinphoneBuffer *buffer = NULL;
-		@try {
-			buffer = linphone_buffer_new_from_data([thiz.data subdataWithRange:NSMakeRange(offset, size)].bytes, size);
-		} @catch (NSException *exception) {
-			LOGE(@"Exception: %@", exception);
-		}
+		if (offset < total)
+			buffer = linphone_buffer_new_from_data((const uint8_t *)thiz.data.bytes + offset, MIN(size, remaining));
 
 		// this is the last time we will be notified, so destroy ourselve
 		if (remaining <= size) {
@@ -267,10 +283,8 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
 }
 
 - (void)uploadData:(NSData *)data  forChatRoom:(LinphoneChatRoom *)chatRoom type:(NSString *)type subtype:(NSString *)subtype name:(NSString *)name key:(NSString *)key keyData:(NSString *)keyData qualityData:(NSNumber *)qualityData {
-    [LinphoneManager.instance.fileTransferDelegates addObject:self];
-    
     LinphoneContent *content = linphone_core_create_content(linphone_chat_room_get_core(chatRoom));
-    _data = [NSMutableData dataWithData:data];
+    _data = data;
     linphone_content_set_type(content, [type UTF8String]);
     linphone_content_set_subtype(content, [subtype UTF8String]);
     linphone_content_set_name(content, [name UTF8String]);
@@ -280,6 +294,7 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
     if (!isOneToOneChat && ![_text isEqualToString:@""])
         linphone_chat_message_add_text_content(_message, [_text UTF8String]);
     linphone_content_unref(content);
+    [LinphoneManager.instance.fileTransferRegistry addDelegate:self];
     
     linphone_chat_message_cbs_set_file_transfer_send(linphone_chat_message_get_callbacks(_message),
                                                      linphone_iphone_file_transfer_send);
@@ -288,8 +303,8 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
     [LinphoneManager setValueInMessageAppData:keyData forKey:key inMessage:_message];
     [LinphoneManager setValueInMessageAppData:qualityData forKey:@"uploadQuality" inMessage:_message];
     
-    LOGI(@"%p Uploading content from message %p", self, _message);
-    linphone_chat_message_send(_message);
+    // the message only shows up in the conversation once sent, do not queue it
+    [LinphoneManager.instance.fileTransferScheduler runTransfer:self];
 }
 
 - (void)upload:(UIImage *)image withassetId:(NSString *)phAssetId forChatRoom:(LinphoneChatRoom *)chatRoom withQuality:(float)quality {
@@ -313,6 +328,8 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
     ChatConversationView *view = VIEW(ChatConversationView);
     NSURL *url = [view getICloudFileUrl:name];
     if ([view writeFileInICloud:data fileURL:url]) {
+        // upload from our copy of the file, mapped instead of being held in memory
+        data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:nil] ?: data;
         AVAsset *asset = [AVURLAsset URLAssetWithURL:url options:nil];
         if ([[asset tracksWithMediaType:AVMediaTypeVideo] count] > 0) {
             // if it's a video
@@ -325,27 +342,85 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
 
 
 
-- (BOOL)download:(LinphoneChatMessage *)message {
-	[[LinphoneManager.instance fileTransferDelegates] addObject:self];
+- (void)openDownloadFile {
+	_receivedSize = 0;
+	_downloadPath = [[LinphoneManager cacheDirectory]
+		stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.download", NSUUID.UUID.UUIDString]];
+	if ([[NSFileManager defaultManager] createFileAtPath:_downloadPath contents:nil attributes:nil])
+		_downloadHandle = [NSFileHandle fileHandleForWritingAtPath:_downloadPath];
+	if (!_downloadHandle)
+		LOGE(@"%p Cannot create download file [%@]", self, _downloadPath);
+}
 
-	_message = message;
+- (void)appendDownloadBytes:(const uint8_t *)bytes length:(size_t)length {
+	if (!_downloadHandle)
+		return;
+	@try {
+		[_downloadHandle writeData:[NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO]];
+		_receivedSize += length;
+	} @catch (NSException *exception) {
+		// the size check at the end of the transfer will report the error
+		LOGE(@"%p Cannot write download file: %@", self, exception);
+		[self closeDownloadFile];
+	}
+}
 
-	const char *url = linphone_chat_message_get_external_body_url(_message);
-	LOGI(@"%p Downloading content in %p from %s", self, message, url);
+- (void)closeDownloadFile {
+	[_downloadHandle closeFile];
+	_downloadHandle = nil;
+}
 
-	if (url == nil)
-		return FALSE;
+- (void)reportProgress:(float)progress {
+	CFTimeInterval now = CACurrentMediaTime();
+	if (progress < 1.f && (progress - _reportedProgress < FILE_TRANSFER_PROGRESS_STEP ||
+						   now - _reportTime < FILE_TRANSFER_PROGRESS_INTERVAL))
+		return;
+	_reportedProgress = progress;
+	_reportTime = now;
+	LOGD(@"%p Transfer of message %p: %.0f%%", self, _message, progress * 100.f);
+	[self.progressDelegate fileTransfer:self didUpdateProgress:progress];
+}
 
-	linphone_chat_message_cbs_set_file_transfer_recv(linphone_chat_message_get_callbacks(_message),
-													 linphone_iphone_file_transfer_recv);
+- (BOOL)download:(LinphoneChatMessage *)message {
+	FileTransferScheduler *scheduler = LinphoneManager.instance.fileTransferScheduler;
+	return [self download:message priority:[scheduler priorityForChatRoom:linphone_chat_message_get_chat_room(message)]];
+}
 
-	linphone_chat_message_download_file(_message);
+- (BOOL)download:(LinphoneChatMessage *)message priority:(FileTransferPriority)priority {
+	const char *url = linphone_chat_message_get_external_body_url(message);
+	if (url == nil) {
+		LOGE(@"%p Cannot download content in %p: no url", self, message);
+		return FALSE;
+	}
 
+	_message = message;
+	[LinphoneManager.instance.fileTransferRegistry addDelegate:self];
+	[LinphoneManager.instance.fileTransferScheduler scheduleTransfer:self priority:priority];
 	return TRUE;
 }
 
+- (void)start {
+	if (_message == NULL || _started)
+		return;
+	_started = TRUE;
+	if (linphone_chat_message_is_outgoing(_message)) {
+		LOGI(@"%p Uploading content from message %p", self, _message);
+		linphone_chat_message_send(_message);
+	} else {
+		LOGI(@"%p Downloading content in %p from %s", self, _message,
+			 linphone_chat_message_get_external_body_url(_message));
+		linphone_chat_message_cbs_set_file_transfer_recv(linphone_chat_message_get_callbacks(_message),
+														 linphone_iphone_file_transfer_recv);
+		linphone_chat_message_download_file(_message);
+	}
+}
+
+- (void)unregister {
+	[LinphoneManager.instance.fileTransferScheduler transferEnded:self];
+	[LinphoneManager.instance.fileTransferRegistry removeDelegate:self];
+}
+
 - (void)stopAndDestroy {
-	[[LinphoneManager.instance fileTransferDelegates] removeObject:self];
 	if (_message != NULL) {
 		LinphoneChatMessage *msg = _message;
 		_message = NULL;
@@ -353,11 +428,19 @@ static LinphoneBuffer *linphone_iphone_file_transfer_send(LinphoneChatMessage *m
 		linphone_chat_message_cbs_set_file_transfer_send(linphone_chat_message_get_callbacks(msg), NULL);
 		linphone_chat_message_cbs_set_file_transfer_recv(linphone_chat_message_get_callbacks(msg), NULL);
 		// when we cancel file transfer, this will automatically trigger NotDelivered callback... recalling ourself a
-		// second time so we have to unset message BEFORE calling this
-		linphone_chat_message_cancel_file_transfer(msg);
+		// second time so we have to unset message BEFORE calling this. A transfer still queued has nothing to cancel
+		if (_started)
+			linphone_chat_message_cancel_file_transfer(msg);
 	}
 	_data = nil;
+	[self closeDownloadFile];
+	if (_downloadPath) {
+		[[NSFileManager defaultManager] removeItemAtPath:_downloadPath error:nil];
+		_downloadPath = nil;
+	}
 	LOGD(@"%p Destroying", self);
+	// last, as the registry and the scheduler may hold the last references on us
+	[self unregister];
 }
 
 - (void)cancel {
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+#include "linphone/linphonecore.h"
+
+@class FileTransferDelegate;
+
+/*
+ * Keeps the file transfers in progress alive and indexes them by message, chat room and file name, so that the
+ * transfer callbacks and the chat views find their delegate without scanning all the transfers.
+ * The indexes are computed when a transfer is added, its message must be set by then. The registry holds a reference
+ * on that message until the transfer is removed. Can be used from any thread.
+ */
+@interface FileTransferRegistry : NSObject
+
+- (void)addDelegate:(FileTransferDelegate *)delegate;
+- (void)removeDelegate:(FileTransferDelegate *)delegate;
+- (void)removeAllDelegates;
+
+- (FileTransferDelegate *)delegateForMessage:(LinphoneChatMessage *)message;
+/* the transfer of a file with this name, in the same direction as message */
+- (FileTransferDelegate *)delegateForFileOfMessage:(LinphoneChatMessage *)message;
+- (NSArray<FileTransferDelegate *> *)delegatesForChatRoom:(LinphoneChatRoom *)chatRoom;
+- (NSArray<FileTransferDelegate *> *)allDelegates;
+
+@property(readonly) NSUInteger count;
+
+@end
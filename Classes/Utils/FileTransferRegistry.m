@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import "FileTransferRegistry.h"
+#import "FileTransferDelegate.h"
+
+@interface FileTransferRegistryEntry : NSObject
+@property(strong) FileTransferDelegate *delegate;
+@property LinphoneChatMessage *message;
+@property(strong) NSValue *chatRoomKey;
+@property(strong) NSString *fileKey;
+@end
+
+@implementation FileTransferRegistryEntry
+@end
+
+@implementation FileTransferRegistry {
+	// the keys of these dictionaries are the pointers of the delegates, messages and chat rooms
+	NSMutableDictionary<NSValue *, FileTransferRegistryEntry *> *entries;
+	NSMutableDictionary<NSValue *, FileTransferRegistryEntry *> *messageIndex;
+	NSMutableDictionary<NSValue *, NSMutableArray<FileTransferDelegate *> *> *chatRoomIndex;
+	NSMutableDictionary<NSString *, NSMutableArray<FileTransferDelegate *> *> *fileIndex;
+}
+
+- (instancetype)init {
+	if ((self = [super init])) {
+		entries = [NSMutableDictionary dictionary];
+		messageIndex = [NSMutableDictionary dictionary];
+		chatRoomIndex = [NSMutableDictionary dictionary];
+		fileIndex = [NSMutableDictionary dictionary];
+	}
+	return self;
+}
+
+- (void)dealloc {
+	[self removeAllDelegates];
+}
+
+static NSString *fileKeyForMessage(LinphoneChatMessage *message) {
+	const LinphoneContent *content = linphone_chat_message_get_file_transfer_information(message);
+	const char *name = content ? linphone_content_get_name(content) : NULL;
+	if (!name)
+		return nil;
+	return [NSString stringWithFormat:@"%d/%s", linphone_chat_message_is_outgoing(message) ? 1 : 0, name];
+}
+
+static void addToIndex(NSMutableDictionary *index, id key, FileTransferDelegate *delegate) {
+	if (!key)
+		return;
+	NSMutableArray *delegates = index[key];
+	if (!delegates)
+		index[key] = delegates = [NSMutableArray array];
+	[delegates addObject:delegate];
+}
+
+static void removeFromIndex(NSMutableDictionary *index, id key, FileTransferDelegate *delegate) {
+	if (!key)
+		return;
+	NSMutableArray *delegates = index[key];
+	[delegates removeObjectIdenticalTo:delegate];
+	if (delegates.count == 0)
+		[index removeObjectForKey:key];
+}
+
+- (void)addDelegate:(FileTransferDelegate *)delegate {
+	LinphoneChatMessage *message = delegate.message;
+	if (!message)
+		return;
+	@synchronized(self) {
+		NSValue *key = [NSValue valueWithPointer:(__bridge void *)delegate];
+		if (entries[key])
+			return;
+		FileTransferRegistryEntry *entry = [[FileTransferRegistryEntry alloc] init];
+		entry.delegate = delegate;
+		entry.message = linphone_chat_message_ref(message);
+		entry.chatRoomKey = [NSValue valueWithPointer:linphone_chat_message_get_chat_room(message)];
+		entry.fileKey = fileKeyForMessage(message);
+		entries[key] = entry;
+		messageIndex[[NSValue valueWithPointer:message]] = entry;
+		addToIndex(chatRoomIndex, entry.chatRoomKey, delegate);
+		addToIndex(fileIndex, entry.fileKey, delegate);
+	}
+}
+
+- (void)removeDelegate:(FileTransferDelegate *)delegate {
+	FileTransferRegistryEntry *entry;
+	@synchronized(self) {
+		NSValue *key = [NSValue valueWithPointer:(__bridge void *)delegate];
+		entry = entries[key];
+		if (!entry)
+			return;
+		[entries removeObjectForKey:key];
+		NSValue *messageKey = [NSValue valueWithPointer:entry.message];
+		if (messageIndex[messageKey] == entry)
+			[messageIndex removeObjectForKey:messageKey];
+		removeFromIndex(chatRoomIndex, entry.chatRoomKey, delegate);
+		removeFromIndex(fileIndex, entry.fileKey, delegate);
+	}
+	// the delegate may be released with its entry, outside of our lock
+	linphone_chat_message_unref(entry.message);
+}
+
+- (void)removeAllDelegates {
+	NSArray<FileTransferRegistryEntry *> *removed;
+	@synchronized(self) {
+		removed = entries.allValues;
+		[entries removeAllObjects];
+		[messageIndex removeAllObjects];
+		[chatRoomIndex removeAllObjects];
+		[fileIndex removeAllObjects];
+	}
+	for (FileTransferRegistryEntry *entry in removed) {
+		linphone_chat_message_unref(entry.message);
+	}
+}
+
+- (FileTransferDelegate *)delegateForMessage:(LinphoneChatMessage *)message {
+	@synchronized(self) {
+		return messageIndex[[NSValue valueWithPointer:message]].delegate;
+	}
+}
+
+- (FileTransferDelegate *)delegateForFileOfMessage:(LinphoneChatMessage *)message {
+	NSString *fileKey = fileKeyForMessage(message);
+	if (!fileKey)
+		return nil;
+	@synchronized(self) {
+		return fileIndex[fileKey].firstObject;
+	}
+}
+
+- (NSArray<FileTransferDelegate *> *)delegatesForChatRoom:(LinphoneChatRoom *)chatRoom {
+	@synchronized(self) {
+		return [chatRoomIndex[[NSValue valueWithPointer:chatRoom]] copy] ?: @[];
+	}
+}
+
+- (NSArray<FileTransferDelegate *> *)allDelegates {
+	@synchronized(self) {
+		NSMutableArray<FileTransferDelegate *> *delegates = [NSMutableArray arrayWithCapacity:entries.count];
+		for (FileTransferRegistryEntry *entry in entries.allValues) {
+			[delegates addObject:entry.delegate];
+		}
+		return delegates;
+	}
+}
+
+- (NSUInteger)count {
+	@synchronized(self) {
+		return entries.count;
+	}
+}
+
+@end
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+#include "linphone/linphonecore.h"
+
+@class FileTransferDelegate;
+
+typedef enum _FileTransferPriority {
+	FileTransferPriorityVisible = 0, // belongs to the conversation on screen
+	FileTransferPriorityNormal,
+	FileTransferPriorityBackground // requested while the application was not active
+} FileTransferPriority;
+
+/*
+ * Limits the number of file transfers running at the same time. Transfers beyond maxConcurrentTransfers wait in a
+ * queue ordered by priority, then by request order, and are started as running ones end. Nothing new is started
+ * while paused (no network), background transfers also wait while backgroundPaused (slow network). Transfers already
+ * running are never interrupted. Must be used from the main thread, except runningCount.
+ */
+@interface FileTransferScheduler : NSObject
+
+- (instancetype)initWithMaxConcurrentTransfers:(NSUInteger)max;
+
+/* Queue a transfer, [FileTransferDelegate start] is called when its turn comes. */
+- (void)scheduleTransfer:(FileTransferDelegate *)ftd priority:(FileTransferPriority)priority;
+/* Start a transfer at once. It takes a slot, so queued transfers wait for it. */
+- (void)runTransfer:(FileTransferDelegate *)ftd;
+/* The transfer ended or was cancelled, whether it was running or still queued. */
+- (void)transferEnded:(FileTransferDelegate *)ftd;
+- (void)removeAllTransfers;
+
+/* priority to give to a new transfer of this chat room */
+- (FileTransferPriority)priorityForChatRoom:(LinphoneChatRoom *)chatRoom;
+
+@property(nonatomic) NSUInteger maxConcurrentTransfers;
+@property(nonatomic) BOOL paused;
+@property(nonatomic) BOOL backgroundPaused;
+/* the conversation on screen, its queued transfers are moved ahead of the others */
+@property(nonatomic) LinphoneChatRoom *visibleChatRoom;
+@property(readonly) NSUInteger runningCount;
+@property(readonly) NSUInteger queuedCount;
+/* deepest the queue has been */
+@property(readonly) NSUInteger maxQueuedCount;
+
+@end
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <UIKit/UIKit.h>
+
+#import "FileTransferScheduler.h"
+#import "FileTransferDelegate.h"
+#import "Log.h"
+
+@interface FileTransferSchedulerEntry : NSObject
+@property(strong) FileTransferDelegate *ftd;
+@property FileTransferPriority priority;
+// request order, to keep the queue fair between transfers of the same priority
+@property unsigned long sequence;
+@end
+
+@implementation FileTransferSchedulerEntry
+@end
+
+@interface FileTransferScheduler ()
+// kept apart from running, it is read by the core scheduler from the core queue
+@property(readwrite) NSUInteger runningCount;
+@end
+
+@implementation FileTransferScheduler {
+	NSMutableArray<FileTransferSchedulerEntry *> *queue;
+	NSMutableArray<FileTransferDelegate *> *running;
+	unsigned long sequence;
+	// a transfer failing as it starts ends re-entrantly, the loop already in progress takes over its slot
+	BOOL starting;
+}
+
+- (instancetype)initWithMaxConcurrentTransfers:(NSUInteger)max {
+	if ((self = [super init])) {
+		queue = [NSMutableArray array];
+		running = [NSMutableArray array];
+		_maxConcurrentTransfers = MAX(max, 1);
+	}
+	return self;
+}
+
+- (NSUInteger)queuedCount {
+	return queue.count;
+}
+
+static NSComparisonResult compareEntries(FileTransferSchedulerEntry *a, FileTransferSchedulerEntry *b) {
+	if (a.priority != b.priority)
+		return a.priority < b.priority ? NSOrderedAscending : NSOrderedDescending;
+	if (a.sequence != b.sequence)
+		return a.sequence < b.sequence ? NSOrderedAscending : NSOrderedDescending;
+	return NSOrderedSame;
+}
+
+- (FileTransferPriority)priorityForChatRoom:(LinphoneChatRoom *)chatRoom {
+	if (chatRoom && chatRoom == _visibleChatRoom)
+		return FileTransferPriorityVisible;
+	if ([UIApplication sharedApplication].applicationState != UIApplicationStateActive)
+		return FileTransferPriorityBackground;
+	return FileTransferPriorityNormal;
+}
+
+- (void)scheduleTransfer:(FileTransferDelegate *)ftd priority:(FileTransferPriority)priority {
+	FileTransferSchedulerEntry *entry = [[FileTransferSchedulerEntry alloc] init];
+	entry.ftd = ftd;
+	entry.priority = priority;
+	entry.sequence = sequence++;
+	NSUInteger index = [queue indexOfObject:entry
+							  inSortedRange:NSMakeRange(0, queue.count)
+									options:NSBinarySearchingInsertionIndex
+							compareWithBlock:^NSComparisonResult(id a, id b) {
+							  return compareEntries(a, b);
+							}];
+	[queue insertObject:entry atIndex:index];
+	_maxQueuedCount = MAX(_maxQueuedCount, queue.count);
+	LOGI(@"%p Transfer queued with priority %d: %lu running, %lu queued", ftd, priority,
+		 (unsigned long)running.count, (unsigned long)queue.count);
+	[self startNextTransfers];
+}
+
+- (void)runTransfer:(FileTransferDelegate *)ftd {
+	[running addObject:ftd];
+	self.runningCount = running.count;
+	LOGI(@"%p Transfer started at once: %lu running, %lu queued", ftd, (unsigned long)running.count,
+		 (unsigned long)queue.count);
+	[ftd start];
+}
+
+- (void)transferEnded:(FileTransferDelegate *)ftd {
+	NSUInteger index = [running indexOfObjectIdenticalTo:ftd];
+	if (index != NSNotFound) {
+		[running removeObjectAtIndex:index];
+		self.runningCount = running.count;
+		[self startNextTransfers];
+		return;
+	}
+	for (index = 0; index < queue.count; index++) {
+		if (queue[index].ftd == ftd) {
+			[queue removeObjectAtIndex:index];
+			return;
+		}
+	}
+}
+
+- (void)removeAllTransfers {
+	LOGI(@"File transfer scheduler: %lu running, %lu queued, at most %lu queued", (unsigned long)running.count,
+		 (unsigned long)queue.count, (unsigned long)_maxQueuedCount);
+	[queue removeAllObjects];
+	[running removeAllObjects];
+	self.runningCount = 0;
+}
+
+- (void)startNextTransfers {
+	if (starting || _paused)
+		return;
+	starting = TRUE;
+	while (running.count < _maxConcurrentTransfers && queue.count > 0) {
+		FileTransferSchedulerEntry *entry = queue.firstObject;
+		// the queue is sorted, only background transfers are left
+		if (_backgroundPaused && entry.priority == FileTransferPriorityBackground)
+			break;
+		[queue removeObjectAtIndex:0];
+		[running addObject:entry.ftd];
+		self.runningCount = running.count;
+		LOGI(@"%p Starting queued transfer: %lu running, %lu queued", entry.ftd, (unsigned long)running.count,
+			 (unsigned long)queue.count);
+		[entry.ftd start];
+	}
+	starting = FALSE;
+}
+
+- (void)setMaxConcurrentTransfers:(NSUInteger)max {
+	_maxConcurrentTransfers = MAX(max, 1);
+	[self startNextTransfers];
+}
+
+- (void)setPaused:(BOOL)paused {
+	if (_paused == paused)
+		return;
+	_paused = paused;
+	LOGI(@"File transfers %s: %lu queued", paused ? "paused" : "resumed", (unsigned long)queue.count);
+	[self startNextTransfers];
+}
+
+- (void)setBackgroundPaused:(BOOL)backgroundPaused {
+	if (_backgroundPaused == backgroundPaused)
+		return;
+	_backgroundPaused = backgroundPaused;
+	LOGI(@"Background file transfers %s", backgroundPaused ? "paused" : "resumed");
+	[self startNextTransfers];
+}
+
+- (void)setVisibleChatRoom:(LinphoneChatRoom *)chatRoom {
+	if (_visibleChatRoom == chatRoom)
+		return;
+	_visibleChatRoom = chatRoom;
+	BOOL changed = FALSE;
+	for (FileTransferSchedulerEntry *entry in queue) {
+		BOOL visible = chatRoom && linphone_chat_message_get_chat_room(entry.ftd.message) == chatRoom;
+		if (visible && entry.priority != FileTransferPriorityVisible) {
+			entry.priority = FileTransferPriorityVisible;
+			changed = TRUE;
+		} else if (!visible && entry.priority == FileTransferPriorityVisible) {
+			// no longer on screen, but it was asked for in the foreground
+			entry.priority = FileTransferPriorityNormal;
+			changed = TRUE;
+		}
+	}
+	if (changed) {
+		[queue sortUsingComparator:^NSComparisonResult(id a, id b) {
+		  return compareEntries(a, b);
+		}];
+		LOGI(@"File transfers of chat room %p moved ahead of the queue", chatRoom);
+		[self startNextTransfers];
+	}
+}
+
+@end
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+/*
+ * Friend list changes made within delay of each other lead to a single refresh of the subscriptions of every friend
+ * list, instead of one SUBSCRIBE/NOTIFY round per edited contact. Must be used from the main thread.
+ */
+@interface FriendListSubscriptionCoalescer : NSObject
+
+- (instancetype)initWithDelay:(NSTimeInterval)delay;
+
+/* Friends were added, changed or removed. restart forces the lists to subscribe again, so that resource lists are
+ * sent anew. */
+- (void)friendsChanged:(BOOL)restart;
+/* refresh at once if a refresh is pending */
+- (void)flush;
+/* drop the pending refresh, the core is going away */
+- (void)cancel;
+
+@property NSTimeInterval delay;
+@property(readonly) unsigned long changes;
+@property(readonly) unsigned long refreshes;
+/* changes which did not need a refresh of their own */
+@property(readonly) unsigned long avoidedRefreshes;
+
+@end
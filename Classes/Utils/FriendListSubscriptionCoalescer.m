@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import "FriendListSubscriptionCoalescer.h"
+#import "LinphoneManager.h"
+
+@implementation FriendListSubscriptionCoalescer {
+	BOOL pending;
+	BOOL restartPending;
+	// tells the scheduled refresh apart from the ones flushed or cancelled before it fired
+	unsigned long generation;
+}
+
+- (instancetype)initWithDelay:(NSTimeInterval)delay {
+	if ((self = [super init])) {
+		_delay = delay;
+	}
+	return self;
+}
+
+- (unsigned long)avoidedRefreshes {
+	return _changes > _refreshes ? _changes - _refreshes : 0;
+}
+
+- (void)friendsChanged:(BOOL)restart {
+	_changes++;
+	restartPending |= restart;
+	if (pending)
+		return;
+	pending = TRUE;
+	unsigned long scheduled = ++generation;
+	__weak FriendListSubscriptionCoalescer *weakSelf = self;
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+	  FriendListSubscriptionCoalescer *strongSelf = weakSelf;
+	  if (strongSelf && strongSelf->generation == scheduled)
+		  [strongSelf flush];
+	});
+}
+
+- (void)flush {
+	if (!pending)
+		return;
+	pending = FALSE;
+	generation++;
+	BOOL restart = restartPending;
+	restartPending = FALSE;
+	if (!LC)
+		return;
+
+	_refreshes++;
+	BOOL enabled = [LinphoneManager.instance lpConfigBoolForKey:@"use_rls_presence"];
+	const MSList *lists = linphone_core_get_friends_lists(LC);
+	while (lists) {
+		if (restart) {
+			linphone_friend_list_enable_subscriptions(lists->data, FALSE);
+			linphone_friend_list_enable_subscriptions(lists->data, enabled);
+		}
+		linphone_friend_list_update_subscriptions(lists->data);
+		lists = lists->next;
+	}
+	LOGI(@"Friend list subscriptions refreshed%s: %lu changes, %lu refreshes, %lu avoided", restart ? " and restarted" : "",
+		 _changes, _refreshes, self.avoidedRefreshes);
+}
+
+- (void)cancel {
+	pending = restartPending = FALSE;
+	generation++;
+}
+
+@end
@@ -21,9 +21,22 @@
 #import <asl.h>
 #import <os/log.h>
 
-#ifdef USE_CRASHLYTHICSS
-#import <Crashlytics/Crashlytics.h>
-#endif
+// everything is logged until the level is known
+int linphone_iphone_log_level = ORTP_DEBUG;
+
+#define LOG_OUTPUT_DEFAULT_CAPACITY 4096
+// at most, when the application terminates or crashes
+#define LOG_OUTPUT_FLUSH_TIMEOUT 1.0
+
+static NSUInteger outputCapacity = LOG_OUTPUT_DEFAULT_CAPACITY;
+static LogSinkOverflowPolicy outputPolicy = LogSinkOverflowDrop;
+static NSUncaughtExceptionHandler *previousExceptionHandler = NULL;
+
+static void log_uncaught_exception(NSException *exception) {
+	[Log flush];
+	if (previousExceptionHandler)
+		previousExceptionHandler(exception);
+}
 
 @implementation Log
 
@@ -48,6 +61,8 @@
 }
 
 + (void)log:(OrtpLogLevel)severity file:(const char *)file line:(int)line format:(NSString *)format, ... {
+	if (!linphone_iphone_log_enabled(severity))
+		return;
 	va_list args;
 	va_start(args, format);
 	NSString *str = [[NSString alloc] initWithFormat:format arguments:args];
@@ -70,11 +85,13 @@
 	if (level == 0) {
 		linphone_core_set_log_level(ORTP_FATAL);
 		ortp_set_log_level("ios", ORTP_FATAL);
+		__atomic_store_n(&linphone_iphone_log_level, ORTP_FATAL, __ATOMIC_RELAXED);
 		NSLog(@"I/%s/Disabling all logs", ORTP_LOG_DOMAIN);
 	} else {
 		NSLog(@"I/%s/Enabling %s logs", ORTP_LOG_DOMAIN, (enabled ? "all" : "application only"));
 		linphone_core_set_log_level(level);
 		ortp_set_log_level("ios", level == ORTP_DEBUG ? ORTP_DEBUG : ORTP_MESSAGE);
+		__atomic_store_n(&linphone_iphone_log_level, level == ORTP_DEBUG ? ORTP_DEBUG : ORTP_MESSAGE, __ATOMIC_RELAXED);
 	}
 }
 
@@ -82,8 +99,40 @@
 	bctbx_log(BCTBX_LOG_DOMAIN, level, "%s", text.cString);
 }
 
++ (void)configureOutputWithCapacity:(NSUInteger)capacity overflowPolicy:(LogSinkOverflowPolicy)policy {
+	outputCapacity = capacity > 0 ? capacity : LOG_OUTPUT_DEFAULT_CAPACITY;
+	outputPolicy = policy;
+}
+
++ (LogSink *)output {
+	static LogSink *output = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		output = [[LogSink alloc] initWithCapacity:outputCapacity];
+		output.overflowPolicy = outputPolicy;
+		previousExceptionHandler = NSGetUncaughtExceptionHandler();
+		NSSetUncaughtExceptionHandler(&log_uncaught_exception);
+	});
+	return output;
+}
+
++ (void)flush {
+	LogSink *output = [self output];
+	[output flushWithTimeout:LOG_OUTPUT_FLUSH_TIMEOUT];
+	if (output.droppedCount > 0)
+		NSLog(@"[Warning] %lu of %lu log lines dropped, buffer of %lu lines full", output.droppedCount,
+			  output.writtenCount + output.droppedCount, (unsigned long)output.capacity);
+}
+
 #pragma mark - Logs Functions callbacks
 
+// printed by the writer thread of output, the caller does not wait for the console
+static void output_line(LogSink *output, NSString *line) {
+	const char *utf8 = line.UTF8String;
+	if (utf8)
+		[output writeLine:strdup(utf8)];
+}
+
 void linphone_iphone_log_handler(const char *domain, OrtpLogLevel lev, const char *fmt, va_list args) {
 	NSString *format = [[NSString alloc] initWithUTF8String:fmt];
 	NSString *formatedString = [[NSString alloc] initWithFormat:format arguments:args];
@@ -116,26 +165,18 @@ void linphone_iphone_log_handler(const char *domain, OrtpLogLevel lev, const cha
 		case ORTP_LOGLEV_END:
 			return;
 	}
+	LogSink *output = [Log output];
 	if ([formatedString containsString:@"\n"]) {
 		NSArray *myWords = [[formatedString stringByReplacingOccurrencesOfString:@"\r\n" withString:@"\n"]
 			componentsSeparatedByString:@"\n"];
 		for (int i = 0; i < myWords.count; i++) {
 			NSString *tab = i > 0 ? @"\t" : @"";
 			if (((NSString *)myWords[i]).length > 0) {
-#ifdef USE_CRASHLYTHICSS
-				CLSNSLog(@"[%@] %@%@", lvl, tab, (NSString *)myWords[i]);
-#else
-				NSLog(@"[%@] %@%@", lvl, tab, (NSString *)myWords[i]);
-#endif
-
+				output_line(output, [NSString stringWithFormat:@"[%@] %@%@", lvl, tab, (NSString *)myWords[i]]);
 			}
 		}
 	} else {
-#ifdef USE_CRASHLYTHICSS
-		CLSNSLog(@"[%@] %@", lvl, [formatedString stringByReplacingOccurrencesOfString:@"\r\n" withString:@"\n"]);
-#else
-		NSLog(@"[%@] %@", lvl, [formatedString stringByReplacingOccurrencesOfString:@"\r\n" withString:@"\n"]);
-#endif
+		output_line(output, [NSString stringWithFormat:@"[%@] %@", lvl, [formatedString stringByReplacingOccurrencesOfString:@"\r\n" withString:@"\n"]]);
 	}
 }
 
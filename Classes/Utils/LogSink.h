@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+typedef enum _LogSinkOverflowPolicy {
+	LogSinkOverflowDrop = 0, // the new line is dropped and counted
+	LogSinkOverflowBlock     // the caller waits for the writer to make room
+} LogSinkOverflowPolicy;
+
+/*
+ * Console output of the logs. Lines are put in a bounded lock-free ring buffer by the threads which log them and
+ * printed by a background writer thread, so that logging does not wait for the console. When the buffer is full,
+ * lines are dropped or the caller waits, depending on overflowPolicy. Dropped lines are counted and reported in the
+ * output. Lines still in the buffer are printed by flush, which is called when the application is terminated or
+ * crashes on an uncaught exception.
+ */
+@interface LogSink : NSObject
+
+/* capacity is rounded up to a power of two */
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/* Takes ownership of line, which must have been allocated with malloc. Returns NO if it was dropped. */
+- (BOOL)writeLine:(char *)line;
+/* waits, at most timeout seconds, for the lines written so far to be printed */
+- (void)flushWithTimeout:(NSTimeInterval)timeout;
+
+@property(readonly) NSUInteger capacity;
+@property LogSinkOverflowPolicy overflowPolicy;
+@property(readonly) unsigned long writtenCount;
+@property(readonly) unsigned long droppedCount;
+
+@end
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#import <stdatomic.h>
+
+#import "LogSink.h"
+
+#ifdef USE_CRASHLYTHICSS
+#import <Crashlytics/Crashlytics.h>
+#endif
+
+typedef struct _LogSlot {
+	// position + 1 once the line is written, position + capacity once it is printed
+	atomic_size_t sequence;
+	char *line;
+} LogSlot;
+
+@implementation LogSink {
+	LogSlot *slots;
+	size_t mask;
+	atomic_size_t writePosition;
+	// only moved by the writer thread, read by flush
+	atomic_size_t printPosition;
+	atomic_ulong written;
+	atomic_ulong dropped;
+	atomic_int policy;
+	// set by the writer thread before it sleeps, so that only the first new line wakes it up
+	atomic_int waiting;
+	dispatch_semaphore_t semaphore;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+	if ((self = [super init])) {
+		_capacity = 1;
+		while (_capacity < MAX(capacity, 2))
+			_capacity <<= 1;
+		mask = _capacity - 1;
+		slots = calloc(_capacity, sizeof(LogSlot));
+		for (size_t i = 0; i < _capacity; i++)
+			atomic_init(&slots[i].sequence, i);
+		atomic_init(&writePosition, 0);
+		atomic_init(&printPosition, 0);
+		atomic_init(&written, 0);
+		atomic_init(&dropped, 0);
+		atomic_init(&policy, LogSinkOverflowDrop);
+		atomic_init(&waiting, 0);
+		semaphore = dispatch_semaphore_create(0);
+		NSThread *thread = [[NSThread alloc] initWithTarget:self selector:@selector(run) object:nil];
+		thread.name = @"org.linphone.logs";
+		thread.qualityOfService = NSQualityOfServiceUtility;
+		[thread start];
+	}
+	return self;
+}
+
+- (LogSinkOverflowPolicy)overflowPolicy {
+	return atomic_load_explicit(&policy, memory_order_relaxed);
+}
+
+- (void)setOverflowPolicy:(LogSinkOverflowPolicy)overflowPolicy {
+	atomic_store_explicit(&policy, overflowPolicy, memory_order_relaxed);
+}
+
+- (unsigned long)writtenCount {
+	return atomic_load_explicit(&written, memory_order_relaxed);
+}
+
+- (unsigned long)droppedCount {
+	return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
+
+- (void)wakeUpWriter {
+	if (atomic_exchange(&waiting, 0))
+		dispatch_semaphore_signal(semaphore);
+}
+
+- (BOOL)writeLine:(char *)line {
+	size_t position = atomic_load_explicit(&writePosition, memory_order_relaxed);
+	LogSlot *slot;
+	while (TRUE) {
+		slot = &slots[position & mask];
+		size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(&writePosition, &position, position + 1,
+													  memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			// full, the line at this slot was not printed yet
+			if (self.overflowPolicy == LogSinkOverflowDrop) {
+				atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+				free(line);
+				return NO;
+			}
+			[self wakeUpWriter];
+			usleep(100);
+			position = atomic_load_explicit(&writePosition, memory_order_relaxed);
+		} else {
+			// taken by another thread meanwhile
+			position = atomic_load_explicit(&writePosition, memory_order_relaxed);
+		}
+	}
+	slot->line = line;
+	atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+	atomic_fetch_add_explicit(&written, 1, memory_order_relaxed);
+	[self wakeUpWriter];
+	return YES;
+}
+
+// writer thread only
+- (char *)nextLine {
+	size_t position = atomic_load_explicit(&printPosition, memory_order_relaxed);
+	LogSlot *slot = &slots[position & mask];
+	if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + 1)
+		return NULL;
+	char *line = slot->line;
+	slot->line = NULL;
+	atomic_store_explicit(&slot->sequence, position + _capacity, memory_order_release);
+	atomic_store_explicit(&printPosition, position + 1, memory_order_release);
+	return line;
+}
+
+- (BOOL)hasLine {
+	size_t position = atomic_load_explicit(&printPosition, memory_order_relaxed);
+	return atomic_load_explicit(&slots[position & mask].sequence, memory_order_acquire) == position + 1;
+}
+
+static void printLine(const char *line) {
+#ifdef USE_CRASHLYTHICSS
+	CLSNSLog(@"%s", line);
+#else
+	NSLog(@"%s", line);
+#endif
+}
+
+- (void)run {
+	unsigned long reportedDropped = 0;
+	while (TRUE) {
+		@autoreleasepool {
+			char *line;
+			while ((line = [self nextLine])) {
+				printLine(line);
+				free(line);
+			}
+			unsigned long droppedNow = self.droppedCount;
+			if (droppedNow != reportedDropped) {
+				char report[64];
+				snprintf(report, sizeof(report), "[Warning] %lu log lines dropped, buffer full",
+						 droppedNow - reportedDropped);
+				printLine(report);
+				reportedDropped = droppedNow;
+			}
+		}
+		atomic_store(&waiting, 1);
+		// a line written before waiting was set would not wake us up
+		if ([self hasLine]) {
+			atomic_store(&waiting, 0);
+			continue;
+		}
+		dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC));
+	}
+}
+
+- (void)flushWithTimeout:(NSTimeInterval)timeout {
+	size_t target = atomic_load(&writePosition);
+	NSDate *limit = [NSDate dateWithTimeIntervalSinceNow:timeout];
+	while (atomic_load_explicit(&printPosition, memory_order_acquire) < target && limit.timeIntervalSinceNow > 0) {
+		[self wakeUpWriter];
+		usleep(1000);
+	}
+}
+
+@end
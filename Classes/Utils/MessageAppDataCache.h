@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <Foundation/Foundation.h>
+
+#include "linphone/linphonecore.h"
+
+/*
+ * The app stores its per message metadata (localimage, localfile, uploadQuality...) as a JSON dictionary in the
+ * message appdata. MessageAppDataCache parses it once per message and serves the following lookups from memory.
+ * An entry is reparsed only when the appdata of the message changed behind our back. Writes update the cached
+ * dictionary immediately and are written back to the message in batches, at the end of the current run loop turn.
+ * Must be used from the main thread, like the messages themselves.
+ */
+@interface MessageAppDataCache : NSObject
+
++ (MessageAppDataCache *)sharedCache;
+
+- (id)valueForKey:(NSString *)key inMessage:(LinphoneChatMessage *)msg;
+/* all the metadata of a message, to read several keys with a single lookup */
+- (NSDictionary *)appDataForMessage:(LinphoneChatMessage *)msg;
+- (void)setValue:(id)value forKey:(NSString *)key inMessage:(LinphoneChatMessage *)msg;
+
+/* write pending changes to the messages right now */
+- (void)flush;
+- (void)clear;
+
+@property(readonly) unsigned long hits;
+@property(readonly) unsigned long misses;
+@property(readonly) unsigned long writes;
+
+@end
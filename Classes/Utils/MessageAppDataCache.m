@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import "MessageAppDataCache.h"
+#import "Log.h"
+
+#define MESSAGE_APPDATA_CACHE_SIZE 2000
+
+@interface MessageAppDataEntry : NSObject
+// appdata the values were parsed from, used to detect changes made outside of the cache
+@property(strong) NSData *raw;
+@property(strong) NSMutableDictionary *values;
+// only set while the entry has changes to write, the message is then referenced
+@property LinphoneChatMessage *message;
+@end
+
+@implementation MessageAppDataEntry
+@end
+
+@implementation MessageAppDataCache {
+	NSCache<NSValue *, MessageAppDataEntry *> *entries;
+	NSMutableDictionary<NSValue *, MessageAppDataEntry *> *pendingEntries;
+	BOOL flushScheduled;
+}
+
++ (MessageAppDataCache *)sharedCache {
+	static MessageAppDataCache *sharedCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedCache = [[MessageAppDataCache alloc] init];
+	});
+	return sharedCache;
+}
+
+- (instancetype)init {
+	if ((self = [super init])) {
+		entries = [[NSCache alloc] init];
+		entries.countLimit = MESSAGE_APPDATA_CACHE_SIZE;
+		pendingEntries = [NSMutableDictionary dictionary];
+	}
+	return self;
+}
+
+// must be called with @synchronized(self)
+- (MessageAppDataEntry *)entryForMessage:(LinphoneChatMessage *)msg {
+	NSValue *key = [NSValue valueWithPointer:msg];
+	MessageAppDataEntry *entry = [pendingEntries objectForKey:key];
+	if (entry)
+		return entry;
+
+	const char *appData = linphone_chat_message_get_appdata(msg);
+	size_t length = appData ? strlen(appData) : 0;
+	entry = [entries objectForKey:key];
+	// comparing the raw appdata is much cheaper than parsing it, and protects us against reused message pointers
+	if (entry && entry.raw.length == length && memcmp(entry.raw.bytes, appData, length) == 0) {
+		_hits++;
+		return entry;
+	}
+
+	_misses++;
+	entry = [[MessageAppDataEntry alloc] init];
+	entry.raw = [NSData dataWithBytes:appData length:length];
+	id values = nil;
+	if (length > 0)
+		values = [NSJSONSerialization JSONObjectWithData:entry.raw options:NSJSONReadingMutableContainers error:nil];
+	entry.values = [values isKindOfClass:NSMutableDictionary.class] ? values : [NSMutableDictionary dictionary];
+	[entries setObject:entry forKey:key];
+	return entry;
+}
+
+- (id)valueForKey:(NSString *)key inMessage:(LinphoneChatMessage *)msg {
+	if (msg == NULL)
+		return nil;
+	@synchronized(self) {
+		return [[self entryForMessage:msg].values objectForKey:key];
+	}
+}
+
+- (NSDictionary *)appDataForMessage:(LinphoneChatMessage *)msg {
+	if (msg == NULL)
+		return nil;
+	@synchronized(self) {
+		return [[self entryForMessage:msg].values copy];
+	}
+}
+
+- (void)setValue:(id)value forKey:(NSString *)key inMessage:(LinphoneChatMessage *)msg {
+	if (msg == NULL)
+		return;
+	@synchronized(self) {
+		MessageAppDataEntry *entry = [self entryForMessage:msg];
+		[entry.values setValue:value forKey:key];
+		if (!entry.message) {
+			entry.message = linphone_chat_message_ref(msg);
+			[pendingEntries setObject:entry forKey:[NSValue valueWithPointer:msg]];
+		}
+		if (!flushScheduled) {
+			flushScheduled = TRUE;
+			dispatch_async(dispatch_get_main_queue(), ^{
+				[self flush];
+			});
+		}
+	}
+}
+
+- (void)flush {
+	@synchronized(self) {
+		flushScheduled = FALSE;
+		for (MessageAppDataEntry *entry in pendingEntries.allValues) {
+			NSData *data = [NSJSONSerialization dataWithJSONObject:entry.values options:0 error:nil];
+			NSString *appdataJSON = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+			linphone_chat_message_set_appdata(entry.message, appdataJSON.UTF8String);
+			entry.raw = data;
+			linphone_chat_message_unref(entry.message);
+			entry.message = NULL;
+			_writes++;
+		}
+		[pendingEntries removeAllObjects];
+	}
+}
+
+- (void)clear {
+	[self flush];
+	@synchronized(self) {
+		LOGI(@"Message appdata cache: %lu hits, %lu misses, %lu writes", _hits, _misses, _writes);
+		[entries removeAllObjects];
+	}
+}
+
+@end
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import <UIKit/UIKit.h>
+
+#include "linphone/linphonecore.h"
+
+/*
+ * Computing the size of a chat bubble means measuring its text and, for file transfers, reading the dimensions of
+ * the attached media from disk or from the photo library. MessageLayoutCache keeps the computed sizes per message,
+ * width and content size category so that table reloads and rotations do not measure every bubble again.
+ * An entry is dropped when the message state changes or when its appdata is written. The original dimensions of
+ * the medias are cached separately, by media identifier, and can be filled from a background queue.
+ */
+@interface MessageLayoutCache : NSObject
+
++ (MessageLayoutCache *)sharedCache;
+
+/* kind distinguishes the different sizes computed for a same message (bubble only, bubble with date...) */
+- (NSValue *)sizeForMessage:(LinphoneChatMessage *)msg kind:(int)kind width:(int)width;
+- (void)setSize:(CGSize)size forMessage:(LinphoneChatMessage *)msg kind:(int)kind width:(int)width;
+- (void)invalidateMessage:(LinphoneChatMessage *)msg;
+
+/* can be called from any thread */
+- (NSValue *)mediaSizeForKey:(NSString *)key;
+- (void)setMediaSize:(CGSize)size forKey:(NSString *)key;
+
+- (void)clear;
+
+@property(readonly) unsigned long hits;
+@property(readonly) unsigned long misses;
+
+@end
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of linphone-iphone
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#import "MessageLayoutCache.h"
+#import "Log.h"
+
+#define MESSAGE_LAYOUT_CACHE_SIZE 1000
+#define MEDIA_SIZE_CACHE_SIZE 500
+
+@interface MessageLayoutEntry : NSObject
+// what the sizes depend on, checked on each lookup as message pointers may be reused
+@property LinphoneChatMessageState state;
+@property time_t time;
+@property(strong) NSString *contentSizeCategory;
+@property(strong) NSMutableDictionary<NSNumber *, NSValue *> *sizes;
+@end
+
+@implementation MessageLayoutEntry
+@end
+
+@implementation MessageLayoutCache {
+	NSCache<NSValue *, MessageLayoutEntry *> *entries;
+	NSCache<NSString *, NSValue *> *mediaSizes;
+	NSString *contentSizeCategory;
+}
+
++ (MessageLayoutCache *)sharedCache {
+	static MessageLayoutCache *sharedCache = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		sharedCache = [[MessageLayoutCache alloc] init];
+	});
+	return sharedCache;
+}
+
+- (instancetype)init {
+	if ((self = [super init])) {
+		entries = [[NSCache alloc] init];
+		entries.countLimit = MESSAGE_LAYOUT_CACHE_SIZE;
+		mediaSizes = [[NSCache alloc] init];
+		mediaSizes.countLimit = MEDIA_SIZE_CACHE_SIZE;
+		contentSizeCategory = UIApplication.sharedApplication.preferredContentSizeCategory;
+		[NSNotificationCenter.defaultCenter addObserver:self
+											   selector:@selector(contentSizeCategoryDidChange:)
+												   name:UIContentSizeCategoryDidChangeNotification
+												 object:nil];
+	}
+	return self;
+}
+
+- (void)dealloc {
+	[NSNotificationCenter.defaultCenter removeObserver:self];
+}
+
+- (void)contentSizeCategoryDidChange:(NSNotification *)notif {
+	@synchronized(self) {
+		contentSizeCategory = UIApplication.sharedApplication.preferredContentSizeCategory;
+	}
+}
+
+static NSNumber *sizeKey(int kind, int width) {
+	return @(((NSInteger)width << 8) | (kind & 0xff));
+}
+
+- (NSValue *)sizeForMessage:(LinphoneChatMessage *)msg kind:(int)kind width:(int)width {
+	if (msg == NULL)
+		return nil;
+	@synchronized(self) {
+		MessageLayoutEntry *entry = [entries objectForKey:[NSValue valueWithPointer:msg]];
+		NSValue *size = nil;
+		if (entry && entry.state == linphone_chat_message_get_state(msg) &&
+			entry.time == linphone_chat_message_get_time(msg) &&
+			[entry.contentSizeCategory isEqualToString:contentSizeCategory])
+			size = [entry.sizes objectForKey:sizeKey(kind, width)];
+		if (size)
+			_hits++;
+		else
+			_misses++;
+		return size;
+	}
+}
+
+- (void)setSize:(CGSize)size forMessage:(LinphoneChatMessage *)msg kind:(int)kind width:(int)width {
+	if (msg == NULL)
+		return;
+	@synchronized(self) {
+		NSValue *key = [NSValue valueWithPointer:msg];
+		MessageLayoutEntry *entry = [entries objectForKey:key];
+		LinphoneChatMessageState state = linphone_chat_message_get_state(msg);
+		time_t time = linphone_chat_message_get_time(msg);
+		if (!entry || entry.state != state || entry.time != time ||
+			![entry.contentSizeCategory isEqualToString:contentSizeCategory]) {
+			entry = [[MessageLayoutEntry alloc] init];
+			entry.state = state;
+			entry.time = time;
+			entry.contentSizeCategory = contentSizeCategory;
+			entry.sizes = [NSMutableDictionary dictionary];
+			[entries setObject:entry forKey:key];
+		}
+		[entry.sizes setObject:[NSValue valueWithCGSize:size] forKey:sizeKey(kind, width)];
+	}
+}
+
+- (void)invalidateMessage:(LinphoneChatMessage *)msg {
+	if (msg == NULL)
+		return;
+	@synchronized(self) {
+		[entries removeObjectForKey:[NSValue valueWithPointer:msg]];
+	}
+}
+
+- (NSValue *)mediaSizeForKey:(NSString *)key {
+	if (!key)
+		return nil;
+	@synchronized(self) {
+		return [mediaSizes objectForKey:key];
+	}
+}
+
+- (void)setMediaSize:(CGSize)size forKey:(NSString *)key {
+	// a zero size means the media could not be read yet (download or export still running), try again next time
+	if (!key || CGSizeEqualToSize(size, CGSizeZero))
+		return;
+	@synchronized(self) {
+		[mediaSizes setObject:[NSValue valueWithCGSize:size] forKey:key];
+	}
+}
+
+- (void)clear {
+	@synchronized(self) {
+		LOGI(@"Message layout cache: %lu hits, %lu misses", _hits, _misses);
+		[entries removeAllObjects];
+		[mediaSizes removeAllObjects];
+	}
+}
+
+@end
@@ -20,18 +20,23 @@
 //  3. This notice may not be removed or altered from any source
 //     distribution.
 //
+//  Altered by Belledonne Communications: keys are kept in an ordered set, for
+//  constant time lookup of their index, and sorted inserts use a binary search.
+//
 
 @interface OrderedDictionary : NSMutableDictionary
 {
 	NSMutableDictionary *dictionary;
-	NSMutableArray *array;
+	NSMutableOrderedSet *array;
 }
 
 - (void)insertObject:(id)anObject forKey:(id)aKey atIndex:(NSUInteger)anIndex;
 // Added by Diorcet Yann
+// Keys must have been kept sorted by sel, the position is found by binary search
 - (void)insertObject:(id)anObject forKey:(id)aKey selector:(SEL) sel;
 //
 - (id)keyAtIndex:(NSUInteger)anIndex;
+- (NSUInteger)indexOfKey:(id)aKey;
 - (NSEnumerator *)reverseKeyEnumerator;
 
 @end
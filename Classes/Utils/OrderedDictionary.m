@@ -20,6 +20,9 @@
 //  3. This notice may not be removed or altered from any source
 //     distribution.
 //
+//  Altered by Belledonne Communications: keys are kept in an ordered set, for
+//  constant time lookup of their index, and sorted inserts use a binary search.
+//
 
 #import "OrderedDictionary.h"
 
@@ -42,7 +45,7 @@ NSString *DescriptionForObject(NSObject *object, id locale, NSUInteger indent) {
 - (void)initObjectsWithCapacity:(NSUInteger)capacity {
 	if (self != nil) {
 		dictionary = [[NSMutableDictionary alloc] initWithCapacity:capacity];
-		array = [[NSMutableArray alloc] initWithCapacity:capacity];
+		array = [[NSMutableOrderedSet alloc] initWithCapacity:capacity];
 	}
 }
 
@@ -54,7 +57,7 @@ NSString *DescriptionForObject(NSObject *object, id locale, NSUInteger indent) {
 
 - (id)initWithCapacity:(NSUInteger)capacity {
 	self = [super init];
-	[self initObjectsWithCapacity:0];
+	[self initObjectsWithCapacity:capacity];
 	return self;
 }
 
@@ -74,6 +77,12 @@ NSString *DescriptionForObject(NSObject *object, id locale, NSUInteger indent) {
 	[array removeObject:aKey];
 }
 
+// the inherited one removes the keys one by one
+- (void)removeAllObjects {
+	[dictionary removeAllObjects];
+	[array removeAllObjects];
+}
+
 - (NSUInteger)count {
 	return [dictionary count];
 }
@@ -86,6 +95,10 @@ NSString *DescriptionForObject(NSObject *object, id locale, NSUInteger indent) {
 	return [array objectEnumerator];
 }
 
+- (NSArray *)allKeys {
+	return [array.array copy];
+}
+
 - (NSEnumerator *)reverseKeyEnumerator {
 	return [array reverseObjectEnumerator];
 }
@@ -95,16 +108,19 @@ NSString *DescriptionForObject(NSObject *object, id locale, NSUInteger indent) {
 	if ([dictionary objectForKey:aKey]) {
 		[self removeObjectForKey:aKey];
 	}
-	NSUInteger anIndex;
 	IMP imp = [aKey methodForSelector:comparator];
 	NSComparisonResult (*func)(id, SEL, id) = (void *)imp;
 
-	for (anIndex = 0; anIndex < [array count]; ++anIndex) {
-		NSComparisonResult result = (NSComparisonResult)func(aKey, comparator, [array objectAtIndex:anIndex]);
-		if (result <= 0) {
-			break;
-		}
-	}
+	// before the first key which is not lower, as the linear search did
+	NSUInteger anIndex = [array indexOfObject:aKey
+								inSortedRange:NSMakeRange(0, array.count)
+									  options:NSBinarySearchingInsertionIndex | NSBinarySearchingFirstEqual
+							  usingComparator:^NSComparisonResult(id a, id b) {
+								// the comparator is always called on the new key, as the linear search did
+								if (a == aKey)
+									return (NSComparisonResult)func(aKey, comparator, b);
+								return (NSComparisonResult)-func(aKey, comparator, a);
+							  }];
 	[array insertObject:aKey atIndex:anIndex];
 	[dictionary setObject:anObject forKey:aKey];
 }
@@ -122,6 +138,10 @@ NSString *DescriptionForObject(NSObject *object, id locale, NSUInteger indent) {
 	return [array objectAtIndex:anIndex];
 }
 
+- (NSUInteger)indexOfKey:(id)aKey {
+	return [array indexOfObject:aKey];
+}
+
 - (NSString *)descriptionWithLocale:(id)locale indent:(NSUInteger)level {
 	NSMutableString *indentString = [NSMutableString string];
 	NSUInteger i, count = level;
@@ -27,6 +27,7 @@
 #import "UILabel+Boldify.h"
 #import "FastAddressBook.h"
 #import "ColorSpaceUtilities.h"
+#import "DateFormatterCache.h"
 
 @implementation LinphoneUtils
 
@@ -47,11 +48,7 @@
 }
 
 + (NSString *) intervalToString:(NSTimeInterval)interval {
-	NSDateComponentsFormatter *formatter = [[NSDateComponentsFormatter alloc] init];
-	formatter.allowedUnits = NSCalendarUnitSecond;
-	formatter.unitsStyle = NSDateComponentsFormatterUnitsStyleAbbreviated;
-	formatter.zeroFormattingBehavior = NSDateComponentsFormatterZeroFormattingBehaviorDropAll;
-	return [formatter stringFromTimeInterval:interval];
+	return [DateFormatterCache.sharedCache stringFromTimeInterval:interval];
 }
 
 
@@ -74,17 +71,10 @@
 
 + (NSString *)timeToString:(time_t)time withFormat:(LinphoneDateFormat)format {
 	NSString *formatstr;
-	NSDate *todayDate = [[NSDate alloc] init];
-	NSDate *messageDate = (time == 0) ? todayDate : [NSDate dateWithTimeIntervalSince1970:time];
-	NSDateComponents *todayComponents =
-		[[NSCalendar currentCalendar] components:NSCalendarUnitDay | NSCalendarUnitMonth | NSCalendarUnitYear
-										fromDate:todayDate];
-	NSDateComponents *dateComponents =
-		[[NSCalendar currentCalendar] components:NSCalendarUnitDay | NSCalendarUnitMonth | NSCalendarUnitYear
-										fromDate:messageDate];
-	BOOL sameYear = (todayComponents.year == dateComponents.year);
-	BOOL sameMonth = (sameYear && (todayComponents.month == dateComponents.month));
-	BOOL sameDay = (sameMonth && (todayComponents.day == dateComponents.day));
+	DateFormatterCache *cache = DateFormatterCache.sharedCache;
+	NSDate *messageDate = (time == 0) ? [NSDate date] : [NSDate dateWithTimeIntervalSince1970:time];
+	BOOL sameYear = [cache isDateInCurrentYear:messageDate];
+	BOOL sameDay = [cache isDateToday:messageDate];
 
 	switch (format) {
 		case LinphoneDateHistoryList:
@@ -126,9 +116,7 @@
 			}
 			break;
 	}
-	NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-	[dateFormatter setDateFormat:formatstr];
-	return [dateFormatter stringFromDate:messageDate];
+	return [cache stringFromDate:messageDate format:formatstr];
 }
 
 + (BOOL)findAndResignFirstResponder:(UIView *)view {
@@ -498,10 +486,9 @@
     NSArray *splitString = [subName componentsSeparatedByString:@"_"];
     //splitString: first element is the 'recording' prefix, last element is the date with the "E-d-MMM-yyyy-HH-mm-ss" format.
     NSString *name = [[splitString subarrayWithRange:NSMakeRange(1, [splitString count] -2)] componentsJoinedByString:@""];
-    NSDateFormatter *format = [[NSDateFormatter alloc] init];
-    [format setDateFormat:@"E-d-MMM-yyyy-HH-mm-ss"];
     NSString *dateWithMkv = [splitString objectAtIndex:[splitString count]-1]; //this will be in the form "E-d-MMM-yyyy-HH-mm-ss.mkv", we have to delete the extension
-    NSDate *date = [format dateFromString:[dateWithMkv substringToIndex:[dateWithMkv length] - 4]];
+    NSDate *date = [DateFormatterCache.sharedCache dateFromString:[dateWithMkv substringToIndex:[dateWithMkv length] - 4]
+                                                           format:@"E-d-MMM-yyyy-HH-mm-ss"];
     NSArray *res = [NSArray arrayWithObjects:name, date, nil];
     return res;
 }
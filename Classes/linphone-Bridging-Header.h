@@ -8,4 +8,5 @@
 #import "FastAddressBook.h"
 #import "Log.h"
 #import "AudioHelper.h"
+#import "DateFormatterCache.h"
 